@@ -9,14 +9,242 @@
 #include "algorithm.hpp"
 #include "algorithm_raser.h"
 #include "algorithm_pegasis_updated.h"
+#include "algorithm_oracle.h"
+#include "oracle_comparison.h"
+#include "hop_log_export.h"
+#include "hop_log_analyzer.h"
+#include "trace_export.h"
+#include "saturation_search.h"
+#include "replicate_runner.h"
+#include "scenario.h"
 
+//The algorithms the search and replicate modes compare, each set up as in the sweep
+const char* const compared_algorithms[] = { "algo", "raser", "pegasis" };
 
-int main()
+std::unique_ptr<DC::AlgorithmBase> make_compared_algorithm(std::string const& name)
 {
+    if (name == "algo") { return std::unique_ptr<DC::AlgorithmBase>(new DC::Algorithm()); }
+    if (name == "raser") { return std::unique_ptr<DC::AlgorithmBase>(new DC::AlgorithmRaser()); }
+    std::unique_ptr<DC::AlgorithmPegasis> pegasis{ new DC::AlgorithmPegasis() };
+    pegasis->set_fusion(std::make_shared<DC::ConcatFusion>());
+    return pegasis;
+}
+
+//One quiet run without a hop log, for the search and replicate modes; safe to call from several threads
+DC::RunSummary simulate(std::string const& name, DC::Topology::Ptr const& topology, int sensor_period, unsigned seed, int message_count,
+    DC::DestinationPolicy destination_policy = DC::DestinationPolicy::random)
+{
+    std::unique_ptr<DC::AlgorithmBase> algorithm = make_compared_algorithm(name);
+    DC::Environment env{ *algorithm, topology, sensor_period, sensor_period, "", seed };
+    std::ostream discard{ nullptr };
+    env.report_to(discard);
+    env.disable_log();
+    env.set_destination_policy(destination_policy);
+    env.run_messages(10000, message_count);
+    return env.summary();
+}
+
+//The algorithm a scenario names, configured from its params; nullptr, with error set, for an unknown name or param value
+std::unique_ptr<DC::AlgorithmBase> make_algorithm(std::string const& name, DC::Scenario const& scenario, std::string& error)
+{
+    if (name == "algo") { return std::unique_ptr<DC::AlgorithmBase>(new DC::Algorithm()); }
+    if (name == "raser") { return std::unique_ptr<DC::AlgorithmBase>(new DC::AlgorithmRaser()); }
+    if (name == "oracle") { return std::unique_ptr<DC::AlgorithmBase>(new DC::AlgorithmOracle()); }
+    if (name == "pegasis")
+    {
+        std::unique_ptr<DC::AlgorithmPegasis> pegasis{ new DC::AlgorithmPegasis() };
+        const std::string fusion = scenario.param("fusion", "none");
+        const std::size_t frame_bytes = static_cast<std::size_t>(std::atoi(scenario.param("frame_bytes", "1024").c_str()));
+        if (fusion == "concat") { pegasis->set_fusion(std::make_shared<DC::ConcatFusion>(frame_bytes)); }
+        else if (fusion == "count") { pegasis->set_fusion(std::make_shared<DC::CountFusion>()); }
+        else if (fusion == "sum") { pegasis->set_fusion(std::make_shared<DC::SumFusion>()); }
+        else if (fusion == "mean") { pegasis->set_fusion(std::make_shared<DC::MeanFusion>()); }
+        else if (fusion == "max") { pegasis->set_fusion(std::make_shared<DC::MaxFusion>()); }
+        else if (fusion != "none")
+        {
+            error = "Unknown fusion " + fusion;
+            return nullptr;
+        }
+        return pegasis;
+    }
+    error = "Unknown algorithm " + name;
+    return nullptr;
+}
+
+int main(int argc, char* argv[])
+{
+    //  WSN_Routing --scenario <scenario file> <summary .tab>
+    //  Runs every algorithm of the scenario at every sensor period it lists
+    if (argc >= 4 && std::string(argv[1]) == "--scenario")
+    {
+        DC::Scenario scenario;
+        std::string error;
+        if (!DC::Scenario::load(argv[2], scenario, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        DC::Topology::Ptr topology = scenario.topology(error);
+        if (!topology)
+        {
+            std::cerr << argv[2] << ": " << error << std::endl;
+            return 1;
+        }
+
+        //The load field only depends on the zones and the topology, so every run shares it
+        DC::LoadField::Ptr load_field = std::make_shared<const DC::LoadField>(scenario.zones_, *topology);
+
+        std::ofstream summary_file{ argv[3] };
+        summary_file << "algorithm\tsensor_period\tcreated\tdelivered\tdelivery_ratio\tavg_hops\tavg_latency\tenergy_mA\tticks\n";
+        for (std::string const& name : scenario.algorithms_)
+        {
+            for (int sensor_period : scenario.sensor_periods_)
+            {
+                std::unique_ptr<DC::AlgorithmBase> algorithm = make_algorithm(name, scenario, error);
+                if (!algorithm)
+                {
+                    std::cerr << error << std::endl;
+                    return 1;
+                }
+                DC::Environment env{ *algorithm, topology, sensor_period, sensor_period, "", scenario.seed_ };
+                std::ostream discard{ nullptr };
+                env.report_to(discard);
+                env.disable_log();
+                env.set_destination_policy(scenario.destination_policy_);
+                env.set_load_field(load_field);
+                env.run_messages(scenario.update_timeframe_, scenario.messages_);
+                DC::RunSummary const& summary = env.summary();
+                summary_file << name << "\t" << sensor_period << "\t" << summary.created_ << "\t" << summary.delivered_ << "\t"
+                    << summary.delivery_ratio_ << "\t" << summary.avg_hops_ << "\t" << summary.avg_latency_ << "\t"
+                    << summary.energy_mA_ << "\t" << summary.ticks_ << "\n";
+            }
+        }
+        return 0;
+    }
+
+    //  WSN_Routing --scenario-binary <scenario file> <output scenario file>
+    //  Writes the scenario, with its positions and actuators spelled out, in the binary format
+    if (argc >= 4 && std::string(argv[1]) == "--scenario-binary")
+    {
+        DC::Scenario scenario;
+        std::string error;
+        if (!DC::Scenario::load(argv[2], scenario, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        DC::Topology::Ptr topology = scenario.topology(error);
+        if (!topology)
+        {
+            std::cerr << argv[2] << ": " << error << std::endl;
+            return 1;
+        }
+        scenario.positions_.clear();
+        for (DC::Topology::Index node = 0; node < topology->size(); ++node)
+        {
+            scenario.positions_.push_back(topology->position(node));
+        }
+        scenario.actuators_ = topology->actuators();
+        return scenario.write_binary(argv[3]) ? 0 : 1;
+    }
+
+    //  WSN_Routing --export-tsv <columnar log> <output .tab> [--arrivals]
+    if (argc >= 4 && std::string(argv[1]) == "--export-tsv")
+    {
+        std::ofstream out{ argv[3] };
+        bool arrival_only = argc >= 5 && std::string(argv[4]) == "--arrivals";
+        return DC::export_hop_log_tsv(argv[2], out, arrival_only) ? 0 : 1;
+    }
+
+    //  WSN_Routing --export-trace <hop log> <output .json> [first tick] [last tick]
+    if (argc >= 4 && std::string(argv[1]) == "--export-trace")
+    {
+        std::ofstream out{ argv[3], std::ios::binary };
+        int first_tick = argc >= 5 ? std::atoi(argv[4]) : 0;
+        int last_tick = argc >= 6 ? std::atoi(argv[5]) : INT_MAX;
+        return DC::export_hop_log_trace(argv[2], out, first_tick, last_tick) ? 0 : 1;
+    }
+
+    //  WSN_Routing --saturation <summary .tab> <runs .tab> [seed count] [min period] [max period]
+    if (argc >= 4 && std::string(argv[1]) == "--saturation")
+    {
+        DC::SaturationOptions options;
+        if (argc >= 5)
+        {
+            options.seeds_.clear();
+            for (int seed = 0; seed < std::atoi(argv[4]); ++seed)
+            {
+                options.seeds_.push_back(15 + seed);
+            }
+        }
+        options.min_period_ = argc >= 6 ? std::atoi(argv[5]) : options.min_period_;
+        options.max_period_ = argc >= 7 ? std::atoi(argv[6]) : options.max_period_;
+        DC::SaturationSearch search{ options };
+        const int message_count = 15000;
+        DC::Topology::Ptr topology = DC::Topology::grid(5, 40, 40, 4, 10);
+
+        std::ofstream summary_file{ argv[2] };
+        DC::SaturationSearch::write_header(summary_file);
+        std::ofstream runs_file{ argv[3] };
+        DC::SaturationSearch::write_runs_header(runs_file);
+        for (const char* name : compared_algorithms)
+        {
+            DC::SaturationResult result = search.find([&](int period, unsigned seed) { return simulate(name, topology, period, seed, message_count); });
+            DC::SaturationSearch::write(summary_file, name, result);
+            DC::SaturationSearch::write_runs(runs_file, name, result);
+        }
+        return 0;
+    }
+
+    //  WSN_Routing --replicate <summary .tab> [sensor period] [max replicates] [threads] [random|nearest|least_loaded|anycast]
+    if (argc >= 3 && std::string(argv[1]) == "--replicate")
+    {
+        DC::ReplicateOptions options;
+        const int sensor_period = argc >= 4 ? std::atoi(argv[3]) : 300;
+        options.max_replicates_ = argc >= 5 ? std::atoi(argv[4]) : options.max_replicates_;
+        options.thread_count_ = argc >= 6 ? static_cast<unsigned>(std::atoi(argv[5])) : options.thread_count_;
+        DC::DestinationPolicy destination_policy = DC::DestinationPolicy::random;
+        if (argc >= 7 && !DC::parse_destination_policy(argv[6], destination_policy))
+        {
+            std::cerr << "Unknown destination policy " << argv[6] << std::endl;
+            return 1;
+        }
+        DC::ReplicateRunner runner{ options };
+        const int message_count = 15000;
+
+        DC::Topology::Ptr topology = DC::Topology::grid(5, 40, 40, 4, 10);
+        std::ofstream summary_file{ argv[2] };
+        DC::ReplicateRunner::write_header(summary_file);
+        for (const char* name : compared_algorithms)
+        {
+            DC::ReplicateRunner::write(summary_file, name, runner.run([&](unsigned seed) { return simulate(name, topology, sensor_period, seed, message_count, destination_policy); }));
+        }
+        return 0;
+    }
+
+    //  WSN_Routing --analyze <summary .tab> <per-source .tab> <hop log>...
+    if (argc >= 5 && std::string(argv[1]) == "--analyze")
+    {
+        std::vector<std::string> files(argv + 4, argv + argc);
+        std::vector<DC::HopLogSummary> summaries = DC::HopLogAnalyzer::analyze_files(files);
+        std::ofstream summary_file{ argv[2] };
+        DC::HopLogAnalyzer::write_summary(summary_file, summaries);
+        std::ofstream sources_file{ argv[3] };
+        DC::HopLogAnalyzer::write_sources(sources_file, summaries);
+        return 0;
+    }
+
     DC::AlgorithmTest test;
     DC::Algorithm algo;
     DC::AlgorithmRaser raser;
     DC::AlgorithmPegasis pegasis;
+    pegasis.set_fusion(std::make_shared<DC::ConcatFusion>());
+    DC::AlgorithmOracle oracle;
+
+    //Every run of the sweep uses the same network, so it is built once
+    DC::Topology::Ptr topology = DC::Topology::grid(5, 40, 40, 4, 10);
+    std::ofstream oracle_file{ "results\\oracle_ratios.tab" };
+    DC::OracleComparison::write_header(oracle_file);
 
     for (int sensor_period = 1500; sensor_period >= 100; sensor_period -= 100)
     {
@@ -24,23 +252,37 @@ int main()
         {
 			int high_load_sensor_period = high_load ? sensor_period / 4 : sensor_period;
 
+            DC::RunSummary oracle_summary;
+            {
+                std::string filename_oracle = "results\\oracle_" + std::to_string(high_load) + "_" + std::to_string(sensor_period) + ".tab";
+                DC::Environment env_oracle{ oracle, topology, sensor_period, high_load_sensor_period, filename_oracle };
+                env_oracle.stream_log();
+                env_oracle.run_messages(10000, 15000);
+                oracle_summary = env_oracle.summary();
+            }
             {
                 std::string filename_algo = "results\\algo_" + std::to_string(high_load) + "_" + std::to_string(sensor_period) + ".tab";
-                DC::Environment env_algo{ algo, 5, 40, 40, 4, 10 , sensor_period, high_load_sensor_period, filename_algo };
+                DC::Environment env_algo{ algo, topology, sensor_period, high_load_sensor_period, filename_algo };
+                env_algo.stream_log();
                 //env_algo.run_timesteps(10000, 5000);
                 env_algo.run_messages(10000, 15000);
+                DC::OracleComparison::write(oracle_file, "algo", sensor_period, high_load, env_algo.summary(), oracle_summary);
             }
             {
                 std::string filename_raser = "results\\raser_" + std::to_string(high_load) + "_" + std::to_string(sensor_period) + ".tab";
-                DC::Environment env_raser{ raser, 5, 40, 40, 4, 10 , sensor_period, high_load_sensor_period, filename_raser };
+                DC::Environment env_raser{ raser, topology, sensor_period, high_load_sensor_period, filename_raser };
+                env_raser.stream_log();
                 //env_raser.run_timesteps(10000, 5000);
                 env_raser.run_messages(10000, 15000);
+                DC::OracleComparison::write(oracle_file, "raser", sensor_period, high_load, env_raser.summary(), oracle_summary);
             }
             {
-                /*std::string filename_pegasis = "results\\pegasis_" + std::to_string(high_load) + "_" + std::to_string(sensor_period) + ".tab";
-                DC::Environment env_pegasis{ pegasis, 5, 40, 40, 1, 10 , sensor_period, high_load_sensor_period, filename_pegasis };
-                env_pegasis.run_timesteps(10000, 5000);
-                env_pegasis.run_messages(10000, 12000);*/
+                std::string filename_pegasis = "results\\pegasis_" + std::to_string(high_load) + "_" + std::to_string(sensor_period) + ".tab";
+                DC::Environment env_pegasis{ pegasis, topology, sensor_period, high_load_sensor_period, filename_pegasis };
+                env_pegasis.stream_log();
+                //env_pegasis.run_timesteps(10000, 5000);
+                env_pegasis.run_messages(10000, 15000);
+                DC::OracleComparison::write(oracle_file, "pegasis", sensor_period, high_load, env_pegasis.summary(), oracle_summary);
             }
         }
 		
@@ -29,9 +29,15 @@ namespace DC
 {
 	class Algorithm : public AlgorithmBase{
 	public:
+		//Orders neighbors by label rather than address, so ties in choose_recipient don't depend on the heap layout
+		struct by_label {
+			bool operator()(Node const* a, Node const* b) const { return a->label() < b->label(); }
+		};
+		using PathValues = std::map<Node*, double, by_label>;
+
 		struct node_metadata {
 								node_metadata() = default;
-			std::map<Node*, std::map<Node*, double>> values_;
+			std::map<Node*, PathValues> values_;
 		};
 
 		struct Signature {
@@ -65,7 +71,8 @@ namespace DC
 		inline void				on_end(std::ostream& os) override;
 
 		inline void				operator()(Node* self, MessagePtr sensor_data) override;
-		inline void				on_tick(std::vector<Node*> nodes, std::vector<Node*> destinations) override {}
+		inline void				on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations) override {}
+		inline bool				quiescent(std::vector<Node*> const& nodes) override { return true; } //All in-flight state lives in the node queues
 	private:
 	    void					update_values(Node* self, Node* destination, Node* neighbor, int distance, int time);
 	    inline static Node*		choose_recipient(Node* self, Node* destination);
@@ -155,7 +162,7 @@ namespace DC
 	inline void Algorithm::update_values(Node* self, Node* destination, Node* neighbor, int distance, int time)
 	{
 		const auto ext_data = self->ext_data<node_metadata>();
-		std::map<Node*, double> paths = ext_data->values_[destination];
+		PathValues paths = ext_data->values_[destination];
 		paths[neighbor] += 10; //Undo the value edit we made when the message was sent
 
 		const double update_val = -1 * (distance + time);
@@ -169,15 +176,12 @@ namespace DC
 		assert(self->neighbors().size() != 0);
 
 		//If one of your neighbors is the destination, send the message to that neighbor
-		for (auto& neighbor : self->neighbors())
+		if (self->has_neighbor(*destination))
 		{
-			if (neighbor->label() == destination->label())
-			{
-				return neighbor;
-			}
+			return destination;
 		}
 
-		std::map<Node*, double> dest_paths = ext_data->values_[destination];
+		PathValues dest_paths = ext_data->values_[destination];
 		Node* best_path = nullptr;
 		double best_val = 1;
 		for (auto&& n : dest_paths)
@@ -1,5 +1,9 @@
 #pragma once
+#include <vector>
+#include <cstdint>
+#include <cassert>
 #include "logger.h"
+#include "message_queue.hpp"
 namespace DC
 {
     class Node;
@@ -18,10 +22,41 @@ namespace DC
         virtual void    on_message_init(MessagePtr msg) = 0;
         virtual void    on_node_init(Node* msg) = 0;
         virtual void    on_neighbor_added(Node* self, Node* neighbor) = 0;
-        virtual void    on_tick(std::vector<Node*> nodes, std::vector<Node*> destinations) = 0;
+        virtual void    on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations) = 0;
         virtual void    on_end(std::ostream& os) = 0;
 
+        // Returning true promises that, while every node's inbox and outbox is empty, on_tick and operator() without sensor data are no-ops,
+        // so the environment may skip those ticks. Algorithms with their own queues, timers or periodic traffic keep the default.
+        virtual bool    quiescent(std::vector<Node*> const& nodes) { return false; }
+
+        // Number of messages the algorithm holds for this node outside its inbox and outbox (sampled by the queue monitor)
+        virtual std::size_t queue_depth(Node* node) { return 0; }
+        // Applies a capacity to that queue; messages dropped from it should be reported with Node::count_drop(dropped)
+        virtual void    bound_queue(Node* node, std::size_t capacity, DropPolicy policy) {}
+
     	virtual void    operator()(Node* self, MessagePtr sensor_data) = 0;
         Logger<MessageHopLogEntry> logger_;
+
+    protected:
+        // Dense per node tables are indexed by label - 1; defined in node.hpp, where Node is complete
+        static inline std::uint32_t index_of(Node const* node);
+        // Position of dest in destinations_, for algorithms that keep per destination state
+        inline std::size_t slot_of(Node const* dest) const;
+
+        std::vector<Node*> destinations_;       // By destination slot; the same for every node (Node::destinations())
     };
+
+    inline std::size_t AlgorithmBase::slot_of(Node const* dest) const
+    {
+        // There are only a handful of destinations
+        for (std::size_t slot = 0; slot < destinations_.size(); ++slot)
+        {
+            if (destinations_[slot] == dest)
+            {
+                return slot;
+            }
+        }
+        assert(false);
+        return 0;
+    }
 }
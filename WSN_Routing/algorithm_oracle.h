@@ -0,0 +1,325 @@
+#pragma once
+#include "algorithm_base.h"
+#include "node.hpp"
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+namespace DC
+{
+	/*
+	 *	Routes every message along a shortest path (in hops) over the physical neighbor graph of the active nodes,
+	 *	as a baseline for the other algorithms: it knows the whole network, so its hop counts are the lower bound and
+	 *	its latency is that of shortest-path routing through the same node queues.
+	 *	A BFS from every destination fills dense per destination slot and per node index tables of hop distances
+	 *	and next hops, so routing a message is one table read. Nodes that leave or join are patched in: a node that
+	 *	leaves only resettles the nodes whose shortest path ran through it, one that joins only relaxes outward from itself.
+	 */
+	class AlgorithmOracle : public AlgorithmBase {
+	public:
+		using Index = std::uint32_t;
+		static constexpr Index NONE = 0xFFFFFFFF;
+
+		struct node_metadata {
+		};
+
+		struct msg_metadata {
+		};
+
+		inline void				on_message_init(MessagePtr msg) override;
+		inline void				on_node_init(Node* self) override;
+		inline void				on_neighbor_added(Node* self, Node* neighbor) override { rebuild_ = true; }
+		inline void				on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations) override;
+		inline void				on_end(std::ostream& os) override {}
+		inline bool				quiescent(std::vector<Node*> const& nodes) override { return true; } //All in-flight state lives in the node queues
+
+		inline void				operator()(Node* self, MessagePtr sensor_data) override;
+
+		//Hops on a shortest path from node to dest through the active nodes, NONE if there is none
+		Index					hops(Node const* node, Node const* dest) const		{ return dist_[at(slot_of(dest), index_of(node))]; }
+
+	private:
+		std::size_t				at(std::size_t slot, Index node) const				{ return slot * nodes_.size() + node; }
+
+		inline void				build(std::vector<Node*> const& nodes);
+		inline void				remove_node(std::size_t slot, Index node);
+		inline void				add_node(std::size_t slot, Index node);
+		inline void				relax_from(std::size_t slot, std::vector<Index>& frontier);
+		inline void				forward(Node* self, MessagePtr msg);
+
+		bool					rebuild_ = true;
+		std::vector<Node*>		nodes_;				//By node index
+		std::vector<char>		active_;			//By node index, as of the last on_tick
+		std::size_t				active_count_ = 0;
+		std::vector<int>		seen_;				//By node index; the last check at which the node was active
+		int						check_ = 0;
+
+		std::vector<Index>		dist_;				//By slot, then node index
+		std::vector<Index>		next_;				//By slot, then node index
+		std::vector<Index>		affected_;			//Scratch space for remove_node
+		std::vector<char>		marked_;
+	};
+
+	inline void AlgorithmOracle::on_message_init(MessagePtr msg)
+	{
+		auto ext_data = new msg_metadata();
+		msg->set_ext_data(ext_data);
+	}
+
+	inline void AlgorithmOracle::on_node_init(Node* self)
+	{
+		self->set_ext_data(new node_metadata());
+
+		//A new node means a new network; the tables are rebuilt on the next tick
+		const Index index = index_of(self);
+		if (index >= nodes_.size())
+		{
+			nodes_.resize(index + 1, nullptr);
+		}
+		nodes_[index] = self;
+		destinations_ = self->destinations();
+		rebuild_ = true;
+	}
+
+	inline void AlgorithmOracle::on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations)
+	{
+		if (rebuild_)
+		{
+			build(nodes);
+			return;
+		}
+
+		//One pass over the active nodes finds the joiners; departures are only looked for when the count says there are some
+		++check_;
+		std::vector<Index> joined;
+		for (Node* node : nodes)
+		{
+			const Index index = index_of(node);
+			seen_[index] = check_;
+			if (!active_[index])
+			{
+				joined.push_back(index);
+			}
+		}
+		if (nodes.size() - joined.size() != active_count_)
+		{
+			for (Index index = 0; index < nodes_.size(); ++index)
+			{
+				if (active_[index] && seen_[index] != check_)
+				{
+					active_[index] = 0;
+					--active_count_;
+					for (std::size_t slot = 0; slot < destinations_.size(); ++slot)
+					{
+						remove_node(slot, index);
+					}
+				}
+			}
+		}
+		for (Index index : joined)
+		{
+			active_[index] = 1;
+			++active_count_;
+			for (std::size_t slot = 0; slot < destinations_.size(); ++slot)
+			{
+				add_node(slot, index);
+			}
+		}
+	}
+
+	inline void AlgorithmOracle::build(std::vector<Node*> const& nodes)
+	{
+		rebuild_ = false;
+		const std::size_t node_count = nodes_.size();
+		active_.assign(node_count, 0);
+		seen_.assign(node_count, check_);
+		marked_.assign(node_count, 0);
+		for (Node* node : nodes)
+		{
+			active_[index_of(node)] = 1;
+		}
+		active_count_ = nodes.size();
+
+		dist_.assign(destinations_.size() * node_count, Index(NONE));
+		next_.assign(destinations_.size() * node_count, Index(NONE));
+		std::vector<Index> frontier;
+		for (std::size_t slot = 0; slot < destinations_.size(); ++slot)
+		{
+			const Index dest = index_of(destinations_[slot]);
+			if (active_[dest])
+			{
+				dist_[at(slot, dest)] = 0;
+				frontier.assign(1, dest);
+				relax_from(slot, frontier);
+			}
+		}
+	}
+
+	inline void AlgorithmOracle::relax_from(std::size_t slot, std::vector<Index>& frontier)
+	{
+		//BFS from frontier (in non-decreasing distance order), lowering the distance of every active node it reaches sooner
+		for (std::size_t head = 0; head < frontier.size(); ++head)
+		{
+			const Index node = frontier[head];
+			const Index next_dist = dist_[at(slot, node)] + 1;
+			for (Node* neighbor : nodes_[node]->neighbors())
+			{
+				const Index other = index_of(neighbor);
+				if (active_[other] && dist_[at(slot, other)] > next_dist)
+				{
+					dist_[at(slot, other)] = next_dist;
+					next_[at(slot, other)] = node;
+					frontier.push_back(other);
+				}
+			}
+		}
+	}
+
+	inline void AlgorithmOracle::remove_node(std::size_t slot, Index node)
+	{
+		//Only the nodes whose next hop chain runs through node can get further away; they are exactly its
+		//subtree in the next hop tree, and every child is a neighbor of its parent
+		affected_.assign(1, node);
+		marked_[node] = 1;
+		for (std::size_t head = 0; head < affected_.size(); ++head)
+		{
+			const Index parent = affected_[head];
+			for (Node* neighbor : nodes_[parent]->neighbors())
+			{
+				const Index child = index_of(neighbor);
+				if (!marked_[child] && next_[at(slot, child)] == parent)
+				{
+					marked_[child] = 1;
+					affected_.push_back(child);
+				}
+			}
+		}
+		for (Index index : affected_)
+		{
+			dist_[at(slot, index)] = NONE;
+			next_[at(slot, index)] = NONE;
+		}
+
+		//Each affected node starts from its best neighbor outside the subtree, then the subtree resettles in
+		//distance order; the seeds are merged into the BFS queue so it stays sorted
+		std::vector<std::pair<Index, Index>> seeds;
+		for (Index index : affected_)
+		{
+			if (index == node)
+			{
+				continue;
+			}
+			for (Node* neighbor : nodes_[index]->neighbors())
+			{
+				const Index other = index_of(neighbor);
+				if (active_[other] && !marked_[other] && dist_[at(slot, other)] != NONE && dist_[at(slot, other)] + 1 < dist_[at(slot, index)])
+				{
+					dist_[at(slot, index)] = dist_[at(slot, other)] + 1;
+					next_[at(slot, index)] = other;
+				}
+			}
+			if (dist_[at(slot, index)] != NONE)
+			{
+				seeds.emplace_back(dist_[at(slot, index)], index);
+			}
+		}
+		for (Index index : affected_)
+		{
+			marked_[index] = 0;
+		}
+		std::sort(seeds.begin(), seeds.end());
+
+		std::vector<Index> queue;
+		std::size_t head = 0;
+		std::size_t seed = 0;
+		while (head < queue.size() || seed < seeds.size())
+		{
+			Index current;
+			if (seed < seeds.size() && (head == queue.size() || seeds[seed].first <= dist_[at(slot, queue[head])]))
+			{
+				if (seeds[seed].first != dist_[at(slot, seeds[seed].second)])
+				{
+					++seed;		//Lowered since it was seeded, so it is in the queue as well
+					continue;
+				}
+				current = seeds[seed++].second;
+			}
+			else
+			{
+				current = queue[head++];
+			}
+			const Index next_dist = dist_[at(slot, current)] + 1;
+			for (Node* neighbor : nodes_[current]->neighbors())
+			{
+				const Index other = index_of(neighbor);
+				if (active_[other] && other != node && dist_[at(slot, other)] > next_dist)
+				{
+					dist_[at(slot, other)] = next_dist;
+					next_[at(slot, other)] = current;
+					queue.push_back(other);
+				}
+			}
+		}
+	}
+
+	inline void AlgorithmOracle::add_node(std::size_t slot, Index node)
+	{
+		//A joining node can only bring others closer, so it takes its best neighbor and relaxes outward from there
+		if (nodes_[node] == destinations_[slot])
+		{
+			dist_[at(slot, node)] = 0;
+		}
+		else
+		{
+			for (Node* neighbor : nodes_[node]->neighbors())
+			{
+				const Index other = index_of(neighbor);
+				if (active_[other] && dist_[at(slot, other)] != NONE && dist_[at(slot, other)] + 1 < dist_[at(slot, node)])
+				{
+					dist_[at(slot, node)] = dist_[at(slot, other)] + 1;
+					next_[at(slot, node)] = other;
+				}
+			}
+		}
+		if (dist_[at(slot, node)] != NONE)
+		{
+			std::vector<Index> frontier(1, node);
+			relax_from(slot, frontier);
+		}
+	}
+
+	inline void AlgorithmOracle::operator()(Node* self, MessagePtr sensor_data)
+	{
+		while (self->inbox_pending())
+		{
+			MessagePtr msg = self->pop_inbox();
+			if (msg->destination() == self)
+			{
+				self->read_msg(msg);
+			}
+			else
+			{
+				forward(self, msg);
+			}
+		}
+		if (sensor_data != nullptr && sensor_data->destination() != nullptr)
+		{
+			forward(self, sensor_data);
+		}
+	}
+
+	inline void AlgorithmOracle::forward(Node* self, MessagePtr msg)
+	{
+		const Index next = next_[at(slot_of(msg->destination()), index_of(self))];
+		if (next == NONE)
+		{
+			//The destination is cut off from this node
+			self->count_drop(msg);
+			return;
+		}
+		msg->set_hop_source(self);
+		msg->set_hop_destination(nodes_[next]);
+		self->push_outbox(msg);
+	}
+}
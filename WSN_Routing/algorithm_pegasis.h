@@ -28,7 +28,7 @@ namespace DC
         inline void             on_message_init(MessagePtr msg) override;
         inline void             on_node_init(Node* msg) override;
 	    inline void             on_neighbor_added(Node* self, Node* neighbor) override {}
-        inline void				on_tick(std::vector<Node*> nodes, std::vector<Node*> destinations) override;
+        inline void				on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations) override;
         inline void             on_end(std::ostream& os) override;
 
         inline void             operator()(Node* self, MessagePtr sensor_data) override;
@@ -138,15 +138,15 @@ namespace DC
         Node* best_option = nullptr;
         node->ext_data<node_metadata>()->disconnected = false; //This node is about to be connected
 
-	    if (has_node(node->neighbors(), dest))
+	    if (node->has_neighbor(*dest))
 	    {
             //The destination is one of your neighbors, forward the message directly
             best_option = &(*dest);
 	    }
-	    else if (has_disconnected_node(node->neighbors()))
+	    else if (has_disconnected_node(node->neighbors().to_vector()))
         {
 	        //There are still nodes that aren't in a chain in your vicinity, forward the message to them
-            best_option = get_closest_node(node->neighbors(), dest, true);
+            best_option = get_closest_node(node->neighbors().to_vector(), dest, true);
             //Since the new neighbor isn't in a chain, 
         }
 
@@ -170,7 +170,7 @@ namespace DC
         furthest->ext_data<node_metadata>()->nearest_neighbors_right[dest] = nullptr;
     }
 
-    inline void AlgorithmPegasis::on_tick(std::vector<Node*> nodes, std::vector<Node*> destinations)
+    inline void AlgorithmPegasis::on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations)
     {
         if (breakCounter_ % 2000 == 0)
         {
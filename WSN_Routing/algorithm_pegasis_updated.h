@@ -1,17 +1,38 @@
 ﻿#pragma once
 #include "algorithm_base.h"
 #include "node.hpp"
-#include <map>
+#include "fusion.h"
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
 
 namespace DC
 {
+    /*
+     *  All chain and round state is kept in dense arrays: per destination slot (the destination's position in
+     *  Node::destinations(), the same for every node) and per node index (label - 1), so the per-tick work of a node
+     *  is a few array reads per destination.
+     */
     class AlgorithmPegasis : public AlgorithmBase {
     public:
+        using Index = std::uint32_t;
+        static constexpr Index NONE = 0xFFFFFFFF;
+
+        struct chain_link {
+            Index left = NONE;
+            Index right = NONE;
+        };
+
 	    struct node_metadata {
 	        node_metadata() = default;
-	        std::map<Node*, Node*> nearest_neighbors_left;
-	        std::map<Node*, Node*> nearest_neighbors_right;
+	        std::vector<chain_link> links;      //By destination slot
+	        std::vector<MessageQueue> queues;   //By destination slot; messages held until that chain's token arrives
+	        std::vector<char> in_chain;         //By destination slot
 	        bool disconnected = true;
+	        bool chain_built = false;           //Set on a destination once its chain exists
+	        int seen = -1;                      //Last chain check at which the node was active
 	    };
 
 	    struct msg_metadata {
@@ -27,25 +48,48 @@ namespace DC
         inline void             on_message_init(MessagePtr msg) override;
         inline void             on_node_init(Node* msg) override;
 	    inline void             on_neighbor_added(Node* self, Node* neighbor) override {}
-        inline void				on_tick(std::vector<Node*> nodes, std::vector<Node*> destinations) override;
+        inline void				on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations) override;
         inline void             on_end(std::ostream& os) override;
 
         inline void             operator()(Node* self, MessagePtr sensor_data) override;
 
+        //With a fusion function, every chain hop sends one aggregate of everything the node holds for that chain
+        //(more only when the fusion's frame fills up); without one, messages are forwarded one by one
+        void                    set_fusion(std::shared_ptr<const Fusion> fusion)                { fusion_ = std::move(fusion); }
+
+        inline std::size_t      queue_depth(Node* node) override;
+        inline void             bound_queue(Node* node, std::size_t capacity, DropPolicy policy) override;
+
     private:
-        bool has_disconnected_node(std::vector<Node*> nodes);
-        inline auto get_furthest_node(std::vector<Node*> nodes, Node* destination, bool needs_disconnected = true);
-	    void connected_create_chain(std::vector<Node*> nodes, Node* dest);
+	    struct chain_info {
+	        std::vector<std::pair<int, Index>> order;  //The chain, left to right, with each node's distance to the destination
+	        Index leftmost = NONE;
+	        Index rightmost = NONE;
+	        Index leader = NONE;
+	        Index current = NONE;           //Holder of the token
+	        bool moving_left = false;
+	        bool second_round = false;
+	        int token_moved = -1;           //Tick at which the token last moved, so it moves one hop per tick
+	    };
 
-	    int breakCounter_ = 0;
+	    node_metadata& meta(Index node)                                       { return *meta_[node]; }
 
-        std::map<Node*, Node*> leaders;
-        std::map<Node*, Node*> current_nodes;
-        std::map<Node*, Node*> leftmost;
-        std::map<Node*, Node*> rightmost;
-        std::map<Node*, bool> moving_left;
-        std::map<Node*, bool> second_round;
+	    inline void connected_create_chain(std::vector<Node*> const& nodes, std::size_t slot);
+	    inline void rebuild_chain(std::vector<Node*> const& nodes, std::size_t slot);
+	    inline void repair_chain(std::vector<Node*> const& nodes, std::size_t slot);
+	    inline void unlink(Index node, std::size_t slot);
+	    inline void link(std::size_t position, std::size_t slot);
+	    inline void start_round(std::size_t slot);
+	    inline void pass_token(Node* self, std::size_t slot);
+	    inline void forward(Node* self, MessageQueue& queue, Node* next, Node* dest);
+	    inline void send_aggregate(Node* self, Node* next, Node* dest, FusionState const& state, std::vector<MessagePtr>& frame);
+
+	    int breakCounter_ = 0;
+	    std::shared_ptr<const Fusion> fusion_;
 
+	    std::vector<Node*> nodes_;              //By node index
+	    std::vector<node_metadata*> meta_;      //By node index; owned by the nodes' ext_data
+	    std::vector<chain_info> chains_;        //By destination slot
     };
 
     inline void AlgorithmPegasis::on_message_init(MessagePtr msg)
@@ -57,91 +101,227 @@ namespace DC
     inline void AlgorithmPegasis::on_node_init(Node* self)
     {
         auto ext_data = new node_metadata();
-        for (Node* n : self->destinations())
+        const std::size_t slots = self->destinations().size();
+        ext_data->links.assign(slots, chain_link());
+        ext_data->queues.resize(slots);
+        ext_data->in_chain.assign(slots, 0);
+        self->set_ext_data(ext_data);
+
+        const Index index = index_of(self);
+        if (index >= nodes_.size())
         {
-            ext_data->nearest_neighbors_left[n] = nullptr; //null_ptr = "no known path"
-            ext_data->nearest_neighbors_right[n] = nullptr; //null_ptr = "no known path"
+            nodes_.resize(index + 1, nullptr);
+            meta_.resize(index + 1, nullptr);
         }
-        self->set_ext_data(ext_data);
+        nodes_[index] = self;
+        meta_[index] = ext_data;
+        destinations_ = self->destinations();
+        chains_.resize(slots);
     }
 
-    inline bool AlgorithmPegasis::has_disconnected_node(std::vector<Node*> nodes)
+    inline void AlgorithmPegasis::connected_create_chain(std::vector<Node*> const& nodes, std::size_t slot)
     {
-        for (auto node = nodes.begin(); node != nodes.end(); ++node)
+        //The greedy chain always links the furthest still disconnected node next, and the destination is fixed,
+        //so it is simply the disconnected nodes by decreasing distance. The stable sort keeps the node order on ties,
+        //as repeatedly scanning for the first strictly furthest node did, and makes this O(N log N) instead of O(N^2).
+        Node* dest = destinations_[slot];
+        std::vector<std::pair<int, Index>> order;
+        order.reserve(nodes.size());
+        for (Node* node : nodes)
+        {
+            if (meta(index_of(node)).disconnected)
+            {
+                order.emplace_back(node->distance_to(*dest), index_of(node));
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [](std::pair<int, Index> const& a, std::pair<int, Index> const& b) { return a.first > b.first; });
+        chain_info& chain = chains_[slot];
+        if (meta(index_of(dest)).chain_built)
         {
-            if ((*node)->ext_data<node_metadata>()->disconnected)
+            //Otherwise the old chain belongs to an earlier network
+            for (auto& member : chain.order)
             {
-                return true;
+                meta(member.second).in_chain[slot] = 0;
             }
         }
+        chain.order = order;
+        chain.leftmost = chain.rightmost = NONE;
+        meta(index_of(dest)).chain_built = true;
 
-        return false;
+        Index previous = NONE;
+        for (auto& member : order)
+        {
+            node_metadata& node = meta(member.second);
+            node.disconnected = false;
+            node.in_chain[slot] = 1;
+            node.links[slot].left = previous;
+            node.links[slot].right = NONE;
+            if (previous != NONE)
+            {
+                meta(previous).links[slot].right = member.second;
+            }
+            previous = member.second;
+        }
+        if (!order.empty())
+        {
+            chain.leftmost = order.front().second;
+            chain.rightmost = order.back().second;
+        }
     }
 
-    inline auto AlgorithmPegasis::get_furthest_node(std::vector<Node*> nodes, Node* destination, bool needs_disconnected)
+    inline void AlgorithmPegasis::rebuild_chain(std::vector<Node*> const& nodes, std::size_t slot)
     {
-        //Gets the furthest disconnected node from the current destination
-        Node* best_node = nullptr;
-        int best_distance = 0;
+        Node* dest = destinations_[slot];
+        for (Node* node : nodes)
+        {
+            meta(index_of(node)).disconnected = (node != dest);
+        }
+
+        //The first leader is the node furthest from the destination
+        connected_create_chain(nodes, slot);
+        chains_[slot].leader = chains_[slot].leftmost;
+        start_round(slot);
+    }
 
-        for (auto curr_node = nodes.begin(); curr_node != nodes.end(); ++curr_node)
+    inline void AlgorithmPegasis::repair_chain(std::vector<Node*> const& nodes, std::size_t slot)
+    {
+        //Nodes that are no longer active are spliced out and new ones are spliced in where a rebuild would put them
+        //(the chain is ordered by decreasing distance to the destination), so the work is proportional to the churn.
+        //A repaired chain is the chain a rebuild would give up to the order of equally distant nodes, so it never
+        //needs rebuilding, and the round in progress carries on.
+        Node* dest = destinations_[slot];
+        chain_info& chain = chains_[slot];
+        bool removed = false;
+        for (auto& member : chain.order)
+        {
+            if (meta(member.second).seen != breakCounter_)
+            {
+                unlink(member.second, slot);
+                meta(member.second).in_chain[slot] = 0;
+                member.second = NONE;
+                removed = true;
+            }
+        }
+        if (removed)
         {
-            auto&& nodeMetadata = *(*curr_node)->ext_data<node_metadata>();
-            auto disconnected = (*curr_node)->ext_data<node_metadata>()->disconnected;
-            auto distance = curr_node.operator*()->distance_to(*destination);
+            chain.order.erase(std::remove_if(chain.order.begin(), chain.order.end(),
+                [](std::pair<int, Index> const& member) { return member.second == NONE; }), chain.order.end());
+        }
 
-	        if (((*curr_node)->ext_data<node_metadata>()->disconnected || !needs_disconnected) && curr_node.operator*()->distance_to(*destination) > best_distance)
-	        {
-                best_node = *curr_node;
-                best_distance = (*curr_node)->distance_to(*destination);
-	        }
+        for (Node* node : nodes)
+        {
+            const Index index = index_of(node);
+            if (node != dest && !meta(index).in_chain[slot])
+            {
+                const int distance = node->distance_to(*dest);
+                auto position = std::upper_bound(chain.order.begin(), chain.order.end(), distance,
+                    [](int distance, std::pair<int, Index> const& member) { return distance > member.first; });
+                position = chain.order.insert(position, std::make_pair(distance, index));
+                meta(index).in_chain[slot] = 1;
+                link(static_cast<std::size_t>(position - chain.order.begin()), slot);
+            }
         }
 
-        return best_node;
+        if (chain.leader == NONE || chain.current == NONE)
+        {
+            //The chain was empty, or lost its leader and every node to its left
+            chain.leader = chain.leader != NONE ? chain.leader : chain.leftmost;
+            start_round(slot);
+        }
     }
 
-    inline void AlgorithmPegasis::connected_create_chain(std::vector<Node*> nodes, Node* dest)
+    inline void AlgorithmPegasis::unlink(Index node, std::size_t slot)
     {
-        Node* furthest = get_furthest_node(nodes, dest);
-        furthest->ext_data<node_metadata>()->disconnected = false;
-        furthest->ext_data<node_metadata>()->nearest_neighbors_left[dest] = nullptr;
-        leftmost[dest] = furthest;
-        while (has_disconnected_node(nodes))
+        chain_info& chain = chains_[slot];
+        chain_link& links = meta(node).links[slot];
+        const Index left = links.left;
+        const Index right = links.right;
+        if (left != NONE)
+        {
+            meta(left).links[slot].right = right;
+        }
+        if (right != NONE)
         {
-            Node* next = get_furthest_node(nodes, dest);
-            furthest->ext_data<node_metadata>()->nearest_neighbors_right[dest] = next;
-            next->ext_data<node_metadata>()->nearest_neighbors_left[dest] = furthest;
-            next->ext_data<node_metadata>()->disconnected = false;
-            furthest = next;
+            meta(right).links[slot].left = left;
         }
+        if (chain.leftmost == node)
+        {
+            chain.leftmost = right;
+        }
+        if (chain.rightmost == node)
+        {
+            chain.rightmost = left;
+        }
+        links = chain_link();
 
-        furthest->ext_data<node_metadata>()->nearest_neighbors_right[dest] = nullptr;
-        rightmost[dest] = furthest;
+        //A leader that left hands off the way a finished leader does; a token it held starts a new round
+        if (chain.leader == node)
+        {
+            chain.leader = left != NONE ? left : chain.rightmost;
+        }
+        if (chain.current == node)
+        {
+            start_round(slot);
+        }
     }
 
-    inline void AlgorithmPegasis::on_tick(std::vector<Node*> nodes, std::vector<Node*> destinations)
+    inline void AlgorithmPegasis::link(std::size_t position, std::size_t slot)
     {
+        chain_info& chain = chains_[slot];
+        const Index node = chain.order[position].second;
+        const Index left = position > 0 ? chain.order[position - 1].second : Index(NONE);
+        const Index right = position + 1 < chain.order.size() ? chain.order[position + 1].second : Index(NONE);
+        meta(node).links[slot].left = left;
+        meta(node).links[slot].right = right;
+        if (left != NONE)
+        {
+            meta(left).links[slot].right = node;
+        }
+        else
+        {
+            chain.leftmost = node;
+        }
+        if (right != NONE)
+        {
+            meta(right).links[slot].left = node;
+        }
+        else
+        {
+            chain.rightmost = node;
+        }
+    }
+
+    inline void AlgorithmPegasis::on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations)
+    {
+        //A destination without a chain means a new network (the instance may be reused across Environments): the
+        //previous network's round state is dropped, and the chains are built on this tick with the checks counted
+        //from here, exactly as on a fresh instance
+        for (std::size_t slot = 0; slot < destinations_.size(); ++slot)
+        {
+            if (!meta(index_of(destinations_[slot])).chain_built)
+            {
+                chains_[slot] = chain_info();
+                breakCounter_ = 0;
+            }
+        }
+
         if (breakCounter_ % 2000 == 0)
         {
-	        for (auto dest = destinations.begin(); dest != destinations.end(); ++dest)
+            //Chains are only built from scratch for a new network and repaired afterwards
+            for (Node* node : nodes)
+            {
+                meta(index_of(node)).seen = breakCounter_;
+            }
+	        for (std::size_t slot = 0; slot < destinations_.size(); ++slot)
 	        {
-		        for (auto node = nodes.begin(); node != nodes.end(); ++node)
-		        {
-	                (*node)->ext_data<node_metadata>()->disconnected = ((*node)->id() != (*dest)->id());
-		        }
-
-	            //while (has_disconnected_node(nodes))
-	            //{
-	            //    Node* destNode = *dest;
-	            //    auto furthest_node = get_furthest_node(nodes, destNode);
-	            //    find_forwarding_node(furthest_node, *dest);
-	            //}
-                connected_create_chain(nodes, *dest);
-                Node* furthest = get_furthest_node(nodes, *dest);
-                leaders[*dest] = furthest;
-                current_nodes[*dest] = furthest;
-                moving_left[*dest] = true;
-                second_round[*dest] = false;
+                if (meta(index_of(destinations_[slot])).chain_built)
+                {
+                    repair_chain(nodes, slot);
+                }
+                else
+                {
+                    rebuild_chain(nodes, slot);
+                }
 	        }
 
             for (auto& node : nodes)
@@ -159,123 +339,163 @@ namespace DC
 
     inline void AlgorithmPegasis::operator()(Node* self, MessagePtr sensor_data)
     {
-        if (sensor_data != nullptr) {
-            //send_sensor_data("This is Data!");
-            //Handle this message
-            MessagePtr msg = sensor_data;
-            Node* dst = msg->destination();
-            if (dst != nullptr) {
-                //This message needs to be forwarded
-                //Find the neighbor most likely to be closest to the destination
-                Node* best_n = self->ext_data<node_metadata>()->nearest_neighbors_left[dst];
+        //Everything received is held for the chain of its own destination, or read if this node is the destination
+        const Index index = index_of(self);
+        node_metadata& self_meta = meta(index);
+        while (self->inbox_pending())
+        {
+            MessagePtr msg = self->pop_inbox();
+            if (msg->destination() == self)
+            {
+                self->read_msg(msg);
+            }
+            else if (MessagePtr dropped = self_meta.queues[slot_of(msg->destination())].push(msg))
+            {
+                self->count_drop(dropped);
+            }
+        }
+        if (sensor_data != nullptr && sensor_data->destination() != nullptr)
+        {
+            if (MessagePtr dropped = self_meta.queues[slot_of(sensor_data->destination())].push(sensor_data))
+            {
+                self->count_drop(dropped);
+            }
+        }
+
+        //Every destination has its own chain and token, so the chains gather independently of each other
+        for (std::size_t slot = 0; slot < chains_.size(); ++slot)
+        {
+            if (chains_[slot].current == index && chains_[slot].token_moved != self->now() && destinations_[slot] != self)
+            {
+                pass_token(self, slot);
+            }
+        }
+    }
+
+    inline void AlgorithmPegasis::start_round(std::size_t slot)
+    {
+        //A round gathers from the leftmost node right to the leader, then from the rightmost node left to the leader
+        chain_info& chain = chains_[slot];
+        chain.current = chain.leftmost;
+        chain.moving_left = false;
+        chain.second_round = false;
+    }
 
+    inline void AlgorithmPegasis::pass_token(Node* self, std::size_t slot)
+    {
+        chain_info& chain = chains_[slot];
+        Node* dest = destinations_[slot];
+        const Index index = index_of(self);
+        chain_link const& links = meta(index).links[slot];
+        MessageQueue& queue = meta(index).queues[slot];
+        chain.token_moved = self->now();
+        if (index != chain.leader)
+        {
+            const Index neighbor = chain.moving_left ? links.left : links.right;
+            if (neighbor == NONE)
+            {
+                //The chain changed under the token and it ran off the end; what this node holds goes with the next round
+                start_round(slot);
+                return;
+            }
+            forward(self, queue, nodes_[neighbor], dest);
+            chain.current = neighbor;
+        }
+        else if (!chain.second_round)
+        {
+            //The left half is gathered; the leader hands the token to the other end of the chain
+            chain.second_round = true;
+            chain.moving_left = true;
+            chain.current = chain.rightmost;
+        }
+        else
+        {
+            //Both halves are gathered: the leader sends everything to the destination and the next node to its left leads
+            forward(self, queue, dest, dest);
+            chain.leader = links.left != NONE ? links.left : chain.rightmost;
+            start_round(slot);
+        }
+    }
+
+    inline void AlgorithmPegasis::forward(Node* self, MessageQueue& queue, Node* next, Node* dest)
+    {
+        if (!fusion_)
+        {
+            while (!queue.empty(self->now()))
+            {
+                MessagePtr msg = queue.pop(self->now());
                 msg->set_hop_source(self);
-                msg->set_hop_destination(best_n);
-                self->push_outbox(msg);
+                msg->set_hop_destination(next);
+                self->send_message(msg);
             }
+            return;
         }
 
-        for (Node* dest : self->destinations())
-        {
-            if (self != dest)
-		    {
-		        if (current_nodes[dest] == self)
-		        {
-			        if (leaders[dest] != self)
-			        {
-		        		if (moving_left[dest])
-		        		{
-		        			Node* neighbor = self->ext_data<node_metadata>()->nearest_neighbors_left[dest];
-		        			if (neighbor == nullptr)
-		        			{
-		        				neighbor = self->ext_data<node_metadata>()->nearest_neighbors_right[dest];
-		        				moving_left[dest] = false;
-		        			}
-		        			while (self->inbox_pending())
-		        			{
-		        				//NOTE: Currently only supports one destination
-		        				//If attempting to support multiple, add one inbox per destination to the node_metadata
-		        				MessagePtr msg = self->pop_inbox();
-		        				msg->set_hop_source(self);
-		        				msg->set_hop_destination(neighbor);
-		        				self->send_message(msg);
-		        			}
-		        			current_nodes[dest] = neighbor;
-		        		}
-			        } else
-			        {
-		        		bool leader_handoff = false;
-		        		if (moving_left[dest])
-		        		{
-		        			if (second_round[dest])
-		        			{
-		        				leader_handoff = true;
-		        			} else
-		        			{
-		        				Node* neighbor = self->ext_data<node_metadata>()->nearest_neighbors_left[dest];
-		        				if (neighbor == nullptr)
-		        				{
-		        					neighbor = self->ext_data<node_metadata>()->nearest_neighbors_right[dest];
-		        					moving_left[dest] = false;
-		        					second_round[dest] = true;
-		        				}
-		        				while (self->inbox_pending())
-		        				{
-		        					//NOTE: Currently only supports one destination
-		        					//If attempting to support multiple, add one inbox per destination to the node_metadata
-		        					MessagePtr msg = self->pop_inbox();
-		        					msg->set_hop_source(self);
-		        					msg->set_hop_destination(neighbor);
-		        					self->send_message(msg);
-		        				}
-		        				current_nodes[dest] = neighbor;
-		        			}
-		        		} else
-		        		{
-		        			second_round[dest] = true;
-		        			Node* neighbor = self->ext_data<node_metadata>()->nearest_neighbors_right[dest];
-		        			if (neighbor == nullptr)
-		        			{
-		        				leader_handoff = true;
-		        			} else
-		        			{
-		        				while (self->inbox_pending())
-		        				{
-		        					//NOTE: Currently only supports one destination
-		        					//If attempting to support multiple, add one inbox per destination to the node_metadata
-		        					MessagePtr msg = self->pop_inbox();
-		        					msg->set_hop_source(self);
-		        					msg->set_hop_destination(neighbor);
-		        					self->send_message(msg);
-		        				}
-		        				current_nodes[dest] = neighbor;
-		        			}
-		        		}
-		        		if (leader_handoff)
-		        		{
-		        			moving_left[dest] = true;
-		        			second_round[dest] = false;
-		        			while (self->inbox_pending())
-		        			{
-		        				//NOTE: Currently only supports one destination
-		        				//If attempting to support multiple, add one inbox per destination to the node_metadata
-		        				MessagePtr msg = self->pop_inbox();
-		        				msg->set_hop_source(self);
-		        				msg->set_hop_destination(dest);
-		        				self->send_message(msg);
-		        			}
-		        			Node* left_neighbor = self->ext_data<node_metadata>()->nearest_neighbors_left[dest];
-		        			leaders[dest] = left_neighbor ? left_neighbor : rightmost[dest];
-		        		}
-			        }
-		        }
-	        } else
-	        {
-		        while (self->inbox_pending())
-		        {
-                    self->read_msg(self->pop_inbox());
-		        }
-	        }
+        //Aggregates from upstream are unpacked, so their readings are fused again together with this node's own
+        FusionState state;
+        std::vector<MessagePtr> frame;
+        auto fuse = [&](MessagePtr const& reading)
+        {
+            if (!frame.empty() && !fusion_->fits(state, *reading))
+            {
+                send_aggregate(self, next, dest, state, frame);
+                state = FusionState();
+            }
+            fusion_->add(state, *reading);
+            frame.push_back(reading);
+        };
+        while (!queue.empty(self->now()))
+        {
+            MessagePtr msg = queue.pop(self->now());
+            if (msg->message_type() == Message::MessageType::aggregate)
+            {
+                for (MessagePtr const& reading : msg->carried())
+                {
+                    fuse(reading);
+                }
+            }
+            else
+            {
+                fuse(msg);
+            }
+        }
+        if (!frame.empty())
+        {
+            send_aggregate(self, next, dest, state, frame);
+        }
+    }
+
+    inline void AlgorithmPegasis::send_aggregate(Node* self, Node* next, Node* dest, FusionState const& state, std::vector<MessagePtr>& frame)
+    {
+        std::string contents = fusion_->contents(state);
+        MessagePtr aggregate{ new Message(self, dest, contents, self->now(), Message::MessageType::aggregate) };
+        on_message_init(aggregate);
+        for (MessagePtr const& reading : frame)
+        {
+            aggregate->carry(reading);
+        }
+        frame.clear();
+        aggregate->set_hop_source(self);
+        aggregate->set_hop_destination(next);
+        self->send_message(aggregate);
+    }
+
+    inline std::size_t AlgorithmPegasis::queue_depth(Node* node)
+    {
+        std::size_t depth = 0;
+        for (auto& queue : meta(index_of(node)).queues)
+        {
+            depth += queue.size();
+        }
+        return depth;
+    }
+
+    inline void AlgorithmPegasis::bound_queue(Node* node, std::size_t capacity, DropPolicy policy)
+    {
+        //Each destination's queue gets the full capacity
+        for (auto& queue : meta(index_of(node)).queues)
+        {
+            queue.set_capacity(capacity, policy);
         }
     }
 
@@ -30,10 +30,12 @@ namespace DC
         inline void                     on_message_init(MessagePtr msg) override;
         inline void                     on_node_init(Node* self) override;
         inline void                     on_neighbor_added(Node* self, Node* neighbor) override;
-        inline void				        on_tick(std::vector<Node*> nodes, std::vector<Node*> destinations) override;
+        inline void				        on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations) override;
         inline void                     on_end(std::ostream& os) override;
 
         void    operator()(Node* node, MessagePtr sensor_data) override;
+        inline std::size_t              queue_depth(Node* node) override { return node->ext_data<node_metadata>()->temp_inbox_.size(); }
+        inline void                     bound_queue(Node* node, std::size_t capacity, DropPolicy policy) override { node->ext_data<node_metadata>()->temp_inbox_.set_capacity(capacity, policy); }
 
     private:
         int num_ticks_ = 0;
@@ -66,7 +68,7 @@ namespace DC
     {
     }
 
-    inline void AlgorithmRaser::on_tick(std::vector<Node*> nodes, std::vector<Node*> destinations)
+    inline void AlgorithmRaser::on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations)
     {
         num_nodes_ = static_cast<int>(nodes.size());
         num_ticks_++;
@@ -92,10 +94,6 @@ namespace DC
             node->add_neighbor(*(msg->hop_source()));
             Node* dst = msg->destination();
 
-            node_metadata node_mtdt = *node->ext_data<node_metadata>();
-            node_metadata sender_mtdt = *msg->hop_source()->ext_data<node_metadata>();
-            msg_metadata msg_mtdt = *msg->ext_data<msg_metadata>();
-
             for (auto& dest : node->destinations())
             {
                 int sender_hop_count = msg->ext_data<msg_metadata>()->sender_hop_counts_[dest];
@@ -133,13 +131,18 @@ namespace DC
 	                    }
 
                         msg->set_hop_destination(nullptr);
+                        MessagePtr dropped;
                         if (msg->priority())
                         {
-                            node->ext_data<node_metadata>()->temp_inbox_.priority_push(msg);
+                            dropped = node->ext_data<node_metadata>()->temp_inbox_.priority_push(msg);
                         }
                     	else
                         {
-                            node->ext_data<node_metadata>()->temp_inbox_.push(msg);
+                            dropped = node->ext_data<node_metadata>()->temp_inbox_.push(msg);
+                        }
+                        if (dropped)
+                        {
+                            node->count_drop(dropped);
                         }
                     }
                 }
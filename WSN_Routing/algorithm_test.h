@@ -17,8 +17,9 @@ namespace DC
 		inline void				on_message_init(MessagePtr msg) override {}
 		inline void				on_node_init(Node* msg) override {}
 		inline void				on_neighbor_added(Node* self, Node* neighbor) override {}
-		inline void				on_tick(std::vector<Node*> nodes, std::vector<Node*> destinations) override {}
+		inline void				on_tick(std::vector<Node*> const& nodes, std::vector<Node*> const& destinations) override {}
 		inline void				on_end(std::ostream& os) override {}
+		inline bool				quiescent(std::vector<Node*> const& nodes) override { return true; }
 
 		inline void				operator()(Node* self, MessagePtr sensor_data) override;
 	};
@@ -0,0 +1,812 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+#include <algorithm>
+
+/*
+ *	Binary columnar log layout (all integers little-endian):
+ *
+ *	File header
+ *		char[8]		magic "WSNCOL1\0"
+ *		uint32		version (2; version 1 files are still read)
+ *		uint32		column count
+ *		per column:	char[16] name (zero padded), uint8 encoding, uint8[3] padding
+ *
+ *	Chunks, back to back until the end of the file, each starting on an 8-byte boundary
+ *		uint32		chunk magic "CHNK"
+ *		uint32		row count
+ *		uint32		payload size in bytes (everything after these three fields, padding included)
+ *		uint32[]	encoded byte size of every column
+ *		bytes		the columns, one after another, then zero padding up to a multiple of 8
+ *
+ *	Every column of a chunk opens with one encoding byte, and the writer picks whichever encoding is smallest
+ *	for that column and chunk, so a chunk can be decoded on its own straight out of a memory-mapped file.
+ *	Signed values are zigzag-mapped, varints are LEB128 (at most 10 bytes), bit fields are packed LSB first.
+ *		delta_varint	every row as a varint of its difference to the previous row
+ *		packed			varint base, uint8 width, then every row's (value - base) in width bits
+ *		delta_packed	varint first value, varint base difference, uint8 width, then the (difference - base) of
+ *						every further row in width bits; timestamps grow by 0 or 1 and take one bit a row
+ *		run_length		pairs of varint (value - previous run's value) and varint (run length - 1)
+ *		delta_run_length varint first value, then run_length of the differences between rows; a node index that
+ *						steps through the TDMA slots is a handful of runs per chunk
+ *		keyed			varint key column, varint value count, then one nested encoding of that many values: the
+ *						column is a function of the key column within the chunk, and the values are those of the
+ *						key's distinct values in order of first appearance. Messages are logged once per hop, so
+ *						their source, sink and start time are stored once per message, not per row.
+ *		offset			varint key column, then one nested encoding of every row's (value - key value)
+ *	Nested encodings are never keyed or offset, nor is the key column of one.
+ *	Version 1 columns carry no encoding byte and are all delta_varint.
+ */
+
+namespace DC
+{
+	class ColumnarLog
+	{
+	public:
+		//tagged in the file header means every chunk gives the column's own encoding
+		enum class Encoding : std::uint8_t { delta_varint = 0, packed = 1, delta_packed = 2, run_length = 3, delta_run_length = 4, keyed = 5, offset = 6, tagged = 0x80 };
+
+		static bool			plain(Encoding encoding)			{ return encoding != Encoding::keyed && encoding != Encoding::offset; }
+
+		static constexpr std::size_t	MAGIC_LENGTH = 8;
+		static constexpr std::uint32_t	VERSION = 2;
+		static constexpr std::uint32_t	CHUNK_MAGIC = 0x4B4E4843; // "CHNK"
+		static constexpr std::size_t	NAME_LENGTH = 16;
+		static constexpr std::size_t	ALIGNMENT = 8;
+		static constexpr std::size_t	MAX_VARINT = 10;	//Bytes of a 64-bit LEB128 varint
+		static constexpr int			MAX_WIDTH = 56;		//Widest bit field, so one 64-bit buffer always holds it
+
+		static char const* magic()							{ return "WSNCOL1"; } // MAGIC_LENGTH bytes with the terminator
+
+		static void put_u32(std::string& out, std::uint32_t value)
+		{
+			for (int byte = 0; byte < 4; ++byte)
+			{
+				out.push_back(static_cast<char>((value >> (8 * byte)) & 0xFF));
+			}
+		}
+
+		static std::uint32_t get_u32(char const* in)
+		{
+			std::uint32_t value = 0;
+			for (int byte = 0; byte < 4; ++byte)
+			{
+				value |= static_cast<std::uint32_t>(static_cast<unsigned char>(in[byte])) << (8 * byte);
+			}
+			return value;
+		}
+
+		static void put_varint(std::string& out, std::uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+				value >>= 7;
+			}
+			out.push_back(static_cast<char>(value));
+		}
+
+		//Returns false on a truncated or overlong varint
+		static bool get_varint(unsigned char const*& in, unsigned char const* end, std::uint64_t& value)
+		{
+			value = 0;
+			for (std::size_t byte = 0; byte < MAX_VARINT && in < end; ++byte)
+			{
+				const unsigned char next = *in++;
+				value |= static_cast<std::uint64_t>(next & 0x7F) << (7 * byte);
+				if (!(next & 0x80))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static int width(std::uint64_t range)
+		{
+			int bits = 0;
+			for (; bits < 64 && (range >> bits) != 0; ++bits) {}
+			return bits;
+		}
+
+		static std::size_t varint_size(std::uint64_t value)
+		{
+			std::size_t bytes = 1;
+			for (; value >= 0x80; value >>= 7)
+			{
+				++bytes;
+			}
+			return bytes;
+		}
+
+		//Bit fields of up to MAX_WIDTH bits, LSB first
+		class BitWriter
+		{
+		public:
+			explicit			BitWriter(std::string& out) : out_(out) {}
+			void				put(std::uint64_t value, int width)
+			{
+				buffer_ |= value << bits_;
+				bits_ += width;
+				for (; bits_ >= 8; bits_ -= 8, buffer_ >>= 8)
+				{
+					out_.push_back(static_cast<char>(buffer_ & 0xFF));
+				}
+			}
+			void				flush()
+			{
+				if (bits_ > 0)
+				{
+					out_.push_back(static_cast<char>(buffer_ & 0xFF));
+				}
+				buffer_ = 0;
+				bits_ = 0;
+			}
+
+		private:
+			std::string&		out_;
+			std::uint64_t		buffer_ = 0;
+			int					bits_ = 0;
+		};
+
+		class BitReader
+		{
+		public:
+								BitReader(unsigned char const* in, unsigned char const* end) : in_(in), end_(end) {}
+			//Returns false past the end of the input
+			bool				get(int width, std::uint64_t& value)
+			{
+				for (; bits_ < width; bits_ += 8)
+				{
+					if (in_ == end_)
+					{
+						return false;
+					}
+					buffer_ |= static_cast<std::uint64_t>(*in_++) << bits_;
+				}
+				value = buffer_ & ((std::uint64_t(1) << width) - 1);
+				buffer_ >>= width;
+				bits_ -= width;
+				return true;
+			}
+			unsigned char const* position() const	{ return in_; }
+
+		private:
+			unsigned char const* in_;
+			unsigned char const* end_;
+			std::uint64_t		buffer_ = 0;
+			int					bits_ = 0;
+		};
+
+		static std::uint64_t zigzag(std::int64_t value)		{ return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63); }
+		static std::int64_t unzigzag(std::uint64_t value)	{ return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1); }
+	};
+	/*
+	 *	Writes the header once, then one chunk at a time:
+	 *		begin_chunk(rows); add_column(...) for every column in schema order; end_chunk();
+	 *	add_column can name the column a value depends on (its key, which has no key of its own); the chunk then
+	 *	stores the column keyed or as an offset from the key wherever that is smaller. Columns are encoded at
+	 *	end_chunk(), and scratch buffers are reused between chunks.
+	 */
+	class ColumnarWriter
+	{
+	public:
+		explicit				ColumnarWriter(std::ostream& os) : os_(os) {}
+
+		inline void				write_header(std::vector<std::string> const& column_names);
+		inline void				begin_chunk(std::size_t rows);
+		template<typename Get>
+		inline void				add_column(Get get, int key = -1);
+		inline void				end_chunk();
+
+	private:
+		using Values			= std::vector<std::int64_t>;
+
+		inline void				encode_column(std::size_t column);
+		inline bool				keyed_values(std::size_t column);
+		static inline void		encode_values(Values const& values, std::string& out);
+
+		std::ostream&			os_;
+		std::string				header_;
+		std::string				columns_;
+		std::string				candidate_;
+		std::vector<std::uint32_t> column_sizes_;
+		std::vector<Values>		values_;
+		std::vector<int>		keys_;
+		Values					keyed_;
+		std::unordered_map<std::int64_t, std::int64_t> key_value_;
+		std::size_t				added_ = 0;
+		std::size_t				rows_ = 0;
+	};
+
+	inline void ColumnarWriter::write_header(std::vector<std::string> const& column_names)
+	{
+		std::string header(ColumnarLog::magic(), ColumnarLog::MAGIC_LENGTH);
+		ColumnarLog::put_u32(header, ColumnarLog::VERSION);
+		ColumnarLog::put_u32(header, static_cast<std::uint32_t>(column_names.size()));
+		for (auto& name : column_names)
+		{
+			std::string padded = name.substr(0, ColumnarLog::NAME_LENGTH);
+			padded.resize(ColumnarLog::NAME_LENGTH, '\0');
+			header += padded;
+			header.push_back(static_cast<char>(ColumnarLog::Encoding::tagged));
+			header.append(3, '\0');
+		}
+		header.append((ColumnarLog::ALIGNMENT - header.size() % ColumnarLog::ALIGNMENT) % ColumnarLog::ALIGNMENT, '\0');
+		os_.write(header.data(), static_cast<std::streamsize>(header.size()));
+	}
+
+	inline void ColumnarWriter::begin_chunk(std::size_t rows)
+	{
+		rows_ = rows;
+		added_ = 0;
+		columns_.clear();
+		column_sizes_.clear();
+	}
+
+	template<typename Get>
+	inline void ColumnarWriter::add_column(Get get, int key)
+	{
+		if (added_ == values_.size())
+		{
+			values_.emplace_back();
+			keys_.push_back(key);
+		}
+		keys_[added_] = key;
+		Values& values = values_[added_++];
+		values.resize(rows_);
+		for (std::size_t row = 0; row < rows_; ++row)
+		{
+			values[row] = get(row);
+		}
+	}
+
+	inline void ColumnarWriter::end_chunk()
+	{
+		if (rows_ == 0)
+		{
+			return;
+		}
+
+		for (std::size_t column = 0; column < added_; ++column)
+		{
+			const std::size_t start = columns_.size();
+			encode_column(column);
+			column_sizes_.push_back(static_cast<std::uint32_t>(columns_.size() - start));
+		}
+
+		std::string table;
+		for (std::uint32_t size : column_sizes_)
+		{
+			ColumnarLog::put_u32(table, size);
+		}
+		const std::size_t unpadded = table.size() + columns_.size();
+		const std::size_t padding = (ColumnarLog::ALIGNMENT - (unpadded + 12) % ColumnarLog::ALIGNMENT) % ColumnarLog::ALIGNMENT;
+
+		header_.clear();
+		ColumnarLog::put_u32(header_, ColumnarLog::CHUNK_MAGIC);
+		ColumnarLog::put_u32(header_, static_cast<std::uint32_t>(rows_));
+		ColumnarLog::put_u32(header_, static_cast<std::uint32_t>(unpadded + padding));
+		header_ += table;
+		columns_.append(padding, '\0');
+
+		os_.write(header_.data(), static_cast<std::streamsize>(header_.size()));
+		os_.write(columns_.data(), static_cast<std::streamsize>(columns_.size()));
+	}
+
+	inline void ColumnarWriter::encode_column(std::size_t column)
+	{
+		const std::size_t start = columns_.size();
+		encode_values(values_[column], columns_);
+		const int key = keys_[column];
+		if (key < 0 || static_cast<std::size_t>(key) >= added_ || static_cast<std::size_t>(key) == column || keys_[key] >= 0)
+		{
+			return;
+		}
+
+		//Whichever of plain, keyed and offset is smallest stays in columns_
+		Values const& keys = values_[key];
+		Values const& values = values_[column];
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			const ColumnarLog::Encoding encoding = pass == 0 ? ColumnarLog::Encoding::keyed : ColumnarLog::Encoding::offset;
+			if (encoding == ColumnarLog::Encoding::keyed && !keyed_values(column))
+			{
+				continue;
+			}
+			if (encoding == ColumnarLog::Encoding::offset)
+			{
+				keyed_.resize(rows_);
+				for (std::size_t row = 0; row < rows_; ++row)
+				{
+					keyed_[row] = values[row] - keys[row];
+				}
+			}
+
+			candidate_.clear();
+			candidate_.push_back(static_cast<char>(encoding));
+			ColumnarLog::put_varint(candidate_, static_cast<std::uint64_t>(key));
+			if (encoding == ColumnarLog::Encoding::keyed)
+			{
+				ColumnarLog::put_varint(candidate_, keyed_.size());
+			}
+			encode_values(keyed_, candidate_);
+			if (candidate_.size() < columns_.size() - start)
+			{
+				columns_.resize(start);
+				columns_ += candidate_;
+			}
+		}
+	}
+
+	//Fills keyed_ with the column's value for every distinct key in order of first appearance, if the key determines it
+	inline bool ColumnarWriter::keyed_values(std::size_t column)
+	{
+		Values const& keys = values_[keys_[column]];
+		Values const& values = values_[column];
+		key_value_.clear();
+		keyed_.clear();
+		for (std::size_t row = 0; row < rows_; ++row)
+		{
+			auto found = key_value_.emplace(keys[row], values[row]);
+			if (found.second)
+			{
+				keyed_.push_back(values[row]);
+			}
+			else if (found.first->second != values[row])
+			{
+				return false;
+			}
+		}
+		return keyed_.size() < rows_;
+	}
+
+	//Writes the encoding byte and the values (at least one) in whichever plain encoding is smallest
+	inline void ColumnarWriter::encode_values(Values const& values, std::string& out)
+	{
+		using Encoding = ColumnarLog::Encoding;
+		const std::size_t count = values.size();
+
+		//One pass sizes every encoding
+		std::int64_t low = values[0];
+		std::int64_t high = values[0];
+		std::int64_t delta_low = 0;
+		std::int64_t delta_high = 0;
+		std::size_t varint_bytes = ColumnarLog::varint_size(ColumnarLog::zigzag(values[0]));
+		std::size_t run_bytes = 0;
+		std::size_t run_start = 0;
+		std::int64_t run_previous = 0;
+		std::size_t delta_run_bytes = ColumnarLog::varint_size(ColumnarLog::zigzag(values[0]));
+		std::size_t delta_run_start = 1;
+		std::int64_t delta_run_previous = 0;
+		for (std::size_t row = 1; row < count; ++row)
+		{
+			const std::int64_t delta = values[row] - values[row - 1];
+			if (row > 1 && delta != values[row - 1] - values[row - 2])
+			{
+				const std::int64_t run_delta = values[delta_run_start] - values[delta_run_start - 1];
+				delta_run_bytes += ColumnarLog::varint_size(ColumnarLog::zigzag(run_delta - delta_run_previous)) + ColumnarLog::varint_size(row - delta_run_start - 1);
+				delta_run_previous = run_delta;
+				delta_run_start = row;
+			}
+			low = std::min(low, values[row]);
+			high = std::max(high, values[row]);
+			delta_low = row == 1 ? delta : std::min(delta_low, delta);
+			delta_high = row == 1 ? delta : std::max(delta_high, delta);
+			varint_bytes += ColumnarLog::varint_size(ColumnarLog::zigzag(delta));
+			if (delta != 0)
+			{
+				run_bytes += ColumnarLog::varint_size(ColumnarLog::zigzag(values[run_start] - run_previous)) + ColumnarLog::varint_size(row - run_start - 1);
+				run_previous = values[run_start];
+				run_start = row;
+			}
+		}
+		run_bytes += ColumnarLog::varint_size(ColumnarLog::zigzag(values[run_start] - run_previous)) + ColumnarLog::varint_size(count - run_start - 1);
+		if (count > 1)
+		{
+			const std::int64_t run_delta = values[delta_run_start] - values[delta_run_start - 1];
+			delta_run_bytes += ColumnarLog::varint_size(ColumnarLog::zigzag(run_delta - delta_run_previous)) + ColumnarLog::varint_size(count - delta_run_start - 1);
+		}
+
+		const int width = ColumnarLog::width(static_cast<std::uint64_t>(high) - static_cast<std::uint64_t>(low));
+		const int delta_width = ColumnarLog::width(static_cast<std::uint64_t>(delta_high) - static_cast<std::uint64_t>(delta_low));
+		const std::size_t packed_bytes = width > ColumnarLog::MAX_WIDTH ? SIZE_MAX
+			: ColumnarLog::varint_size(ColumnarLog::zigzag(low)) + 1 + (count * width + 7) / 8;
+		const std::size_t delta_packed_bytes = delta_width > ColumnarLog::MAX_WIDTH ? SIZE_MAX
+			: ColumnarLog::varint_size(ColumnarLog::zigzag(values[0])) + ColumnarLog::varint_size(ColumnarLog::zigzag(delta_low)) + 1 + ((count - 1) * delta_width + 7) / 8;
+
+		Encoding encoding = Encoding::delta_varint;
+		std::size_t smallest = varint_bytes;
+		if (packed_bytes < smallest)
+		{
+			encoding = Encoding::packed;
+			smallest = packed_bytes;
+		}
+		if (delta_packed_bytes < smallest)
+		{
+			encoding = Encoding::delta_packed;
+			smallest = delta_packed_bytes;
+		}
+		if (run_bytes < smallest)
+		{
+			encoding = Encoding::run_length;
+			smallest = run_bytes;
+		}
+		if (delta_run_bytes < smallest)
+		{
+			encoding = Encoding::delta_run_length;
+		}
+
+		out.push_back(static_cast<char>(encoding));
+		ColumnarLog::BitWriter bits{ out };
+		switch (encoding)
+		{
+		case Encoding::packed:
+			ColumnarLog::put_varint(out, ColumnarLog::zigzag(low));
+			out.push_back(static_cast<char>(width));
+			for (std::size_t row = 0; row < count; ++row)
+			{
+				bits.put(static_cast<std::uint64_t>(values[row]) - static_cast<std::uint64_t>(low), width);
+			}
+			bits.flush();
+			break;
+		case Encoding::delta_packed:
+			ColumnarLog::put_varint(out, ColumnarLog::zigzag(values[0]));
+			ColumnarLog::put_varint(out, ColumnarLog::zigzag(delta_low));
+			out.push_back(static_cast<char>(delta_width));
+			for (std::size_t row = 1; row < count; ++row)
+			{
+				bits.put(static_cast<std::uint64_t>(values[row] - values[row - 1]) - static_cast<std::uint64_t>(delta_low), delta_width);
+			}
+			bits.flush();
+			break;
+		case Encoding::run_length:
+			run_start = 0;
+			run_previous = 0;
+			for (std::size_t row = 1; row <= count; ++row)
+			{
+				if (row == count || values[row] != values[row - 1])
+				{
+					ColumnarLog::put_varint(out, ColumnarLog::zigzag(values[run_start] - run_previous));
+					ColumnarLog::put_varint(out, row - run_start - 1);
+					run_previous = values[run_start];
+					run_start = row;
+				}
+			}
+			break;
+		case Encoding::delta_run_length:
+			ColumnarLog::put_varint(out, ColumnarLog::zigzag(values[0]));
+			run_start = 1;
+			run_previous = 0;
+			for (std::size_t row = 2; row <= count; ++row)
+			{
+				if (row == count || values[row] - values[row - 1] != values[row - 1] - values[row - 2])
+				{
+					const std::int64_t run_delta = values[run_start] - values[run_start - 1];
+					ColumnarLog::put_varint(out, ColumnarLog::zigzag(run_delta - run_previous));
+					ColumnarLog::put_varint(out, row - run_start - 1);
+					run_previous = run_delta;
+					run_start = row;
+				}
+			}
+			break;
+		default:
+			for (std::size_t row = 0; row < count; ++row)
+			{
+				ColumnarLog::put_varint(out, ColumnarLog::zigzag(values[row] - (row > 0 ? values[row - 1] : 0)));
+			}
+			break;
+		}
+	}
+
+	/*
+	 *	Walks the chunks of a columnar log held in memory (normally a MappedFile).
+	 *	valid() is false if the header does not parse. next_chunk() returns false at the end, and also on a damaged
+	 *	chunk, after which damaged() is true; decode_column() returns false if the column doesn't decode.
+	 */
+	class ColumnarReader
+	{
+	public:
+		inline					ColumnarReader(char const* data, std::size_t size);
+
+		bool					valid() const							{ return valid_; }
+		bool					damaged() const							{ return damaged_; }
+		std::size_t				column_count() const					{ return names_.size(); }
+		std::string const&		column_name(std::size_t column) const	{ return names_[column]; }
+		inline int				column_index(std::string const& name) const;
+
+		inline bool				next_chunk();
+		std::size_t				rows() const							{ return rows_; }
+		inline bool				decode_column(std::size_t column, std::vector<int>& out) const;
+
+	private:
+		static inline bool		decode_values(ColumnarLog::Encoding encoding, unsigned char const* in, unsigned char const* end,
+									std::size_t count, std::vector<int>& out);
+
+		char const*				data_;
+		std::size_t				size_;
+		std::size_t				next_ = 0;
+		bool					valid_ = false;
+		bool					tagged_ = false;		//Version 2: every chunk column opens with its encoding
+		bool					damaged_ = false;
+		std::vector<std::string> names_;
+
+		std::size_t				rows_ = 0;
+		std::vector<char const*> column_begin_;
+		std::vector<char const*> column_end_;
+	};
+
+	inline ColumnarReader::ColumnarReader(char const* data, std::size_t size) : data_(data), size_(size)
+	{
+		const std::size_t fixed = ColumnarLog::MAGIC_LENGTH + 8;
+		if (size_ < fixed || std::memcmp(data_, ColumnarLog::magic(), ColumnarLog::MAGIC_LENGTH) != 0)
+		{
+			return;
+		}
+		const std::uint32_t version = ColumnarLog::get_u32(data_ + 8);
+		if (version != 1 && version != ColumnarLog::VERSION)
+		{
+			return;
+		}
+		tagged_ = version == ColumnarLog::VERSION;
+
+		const std::uint32_t columns = ColumnarLog::get_u32(data_ + 12);
+		const std::size_t entry_size = ColumnarLog::NAME_LENGTH + 4;
+		if (size_ < fixed + columns * entry_size)
+		{
+			return;
+		}
+		const ColumnarLog::Encoding expected = tagged_ ? ColumnarLog::Encoding::tagged : ColumnarLog::Encoding::delta_varint;
+		for (std::uint32_t column = 0; column < columns; ++column)
+		{
+			char const* entry = data_ + fixed + column * entry_size;
+			if (entry[ColumnarLog::NAME_LENGTH] != static_cast<char>(expected))
+			{
+				return;
+			}
+			names_.push_back(std::string(entry, strnlen(entry, ColumnarLog::NAME_LENGTH)));
+		}
+
+		next_ = fixed + columns * entry_size;
+		next_ += (ColumnarLog::ALIGNMENT - next_ % ColumnarLog::ALIGNMENT) % ColumnarLog::ALIGNMENT;
+		column_begin_.resize(columns);
+		column_end_.resize(columns);
+		valid_ = true;
+	}
+
+	inline int ColumnarReader::column_index(std::string const& name) const
+	{
+		for (std::size_t column = 0; column < names_.size(); ++column)
+		{
+			if (names_[column] == name)
+			{
+				return static_cast<int>(column);
+			}
+		}
+		return -1;
+	}
+
+	inline bool ColumnarReader::next_chunk()
+	{
+		rows_ = 0;
+		if (!valid_ || damaged_ || next_ == size_)
+		{
+			return false;
+		}
+		damaged_ = true;
+		if (next_ + 12 > size_)
+		{
+			return false;
+		}
+
+		char const* chunk = data_ + next_;
+		const std::size_t payload = ColumnarLog::get_u32(chunk + 8);
+		const std::size_t table = 4 * names_.size();
+		if (ColumnarLog::get_u32(chunk) != ColumnarLog::CHUNK_MAGIC || next_ + 12 + payload > size_ || payload < table)
+		{
+			return false;
+		}
+
+		char const* column = chunk + 12 + table;
+		char const* end = chunk + 12 + payload;
+		for (std::size_t ndx = 0; ndx < names_.size(); ++ndx)
+		{
+			column_begin_[ndx] = column;
+			const std::size_t length = ColumnarLog::get_u32(chunk + 12 + 4 * ndx);
+			if (length > static_cast<std::size_t>(end - column))
+			{
+				return false;
+			}
+			column += length;
+			column_end_[ndx] = column;
+		}
+
+		damaged_ = false;
+		rows_ = ColumnarLog::get_u32(chunk + 4);
+		next_ += 12 + payload;
+		return true;
+	}
+
+	inline bool ColumnarReader::decode_column(std::size_t column, std::vector<int>& out) const
+	{
+		using Encoding = ColumnarLog::Encoding;
+		unsigned char const* in = reinterpret_cast<unsigned char const*>(column_begin_[column]);
+		unsigned char const* end = reinterpret_cast<unsigned char const*>(column_end_[column]);
+		if (!tagged_)
+		{
+			return decode_values(Encoding::delta_varint, in, end, rows_, out);
+		}
+		if (in == end)
+		{
+			return false;
+		}
+		const Encoding encoding = static_cast<Encoding>(*in++);
+		if (ColumnarLog::plain(encoding))
+		{
+			return decode_values(encoding, in, end, rows_, out);
+		}
+
+		//The key column must decode on its own, which also rules out cycles
+		std::uint64_t key = 0;
+		std::uint64_t count = rows_;
+		if (!ColumnarLog::get_varint(in, end, key) || key >= names_.size() || column_begin_[key] == column_end_[key]
+			|| !ColumnarLog::plain(static_cast<Encoding>(*column_begin_[key])))
+		{
+			return false;
+		}
+		if (encoding == Encoding::keyed && (!ColumnarLog::get_varint(in, end, count) || count > rows_))
+		{
+			return false;
+		}
+		std::vector<int> values;
+		std::vector<int> keys;
+		if (in == end || !ColumnarLog::plain(static_cast<Encoding>(*in)))
+		{
+			return false;
+		}
+		const Encoding nested = static_cast<Encoding>(*in++);
+		if (!decode_values(nested, in, end, static_cast<std::size_t>(count), values) || !decode_column(static_cast<std::size_t>(key), keys))
+		{
+			return false;
+		}
+
+		out.resize(rows_);
+		if (encoding == Encoding::offset)
+		{
+			for (std::size_t row = 0; row < rows_; ++row)
+			{
+				out[row] = static_cast<int>(static_cast<unsigned int>(keys[row]) + static_cast<unsigned int>(values[row]));
+			}
+			return true;
+		}
+
+		std::unordered_map<int, int> value_of;
+		value_of.reserve(values.size());
+		std::size_t next = 0;
+		for (std::size_t row = 0; row < rows_; ++row)
+		{
+			auto found = value_of.emplace(keys[row], 0);
+			if (found.second)
+			{
+				if (next == values.size())
+				{
+					return false;
+				}
+				found.first->second = values[next++];
+			}
+			out[row] = found.first->second;
+		}
+		return next == values.size();
+	}
+
+	//Arithmetic is modular, so damaged input can give wrong values but never overflows
+	inline bool ColumnarReader::decode_values(ColumnarLog::Encoding encoding, unsigned char const* in, unsigned char const* end,
+		std::size_t count, std::vector<int>& out)
+	{
+		using Encoding = ColumnarLog::Encoding;
+		out.resize(count);
+		std::uint64_t raw = 0;
+		std::uint64_t value = 0;
+		switch (encoding)
+		{
+		case Encoding::delta_varint:
+			for (std::size_t row = 0; row < count; ++row)
+			{
+				if (!ColumnarLog::get_varint(in, end, raw))
+				{
+					return false;
+				}
+				value += static_cast<std::uint64_t>(ColumnarLog::unzigzag(raw));
+				out[row] = static_cast<int>(static_cast<std::int64_t>(value));
+			}
+			return true;
+
+		case Encoding::packed:
+		case Encoding::delta_packed:
+		{
+			std::uint64_t base = 0;
+			std::size_t row = 0;
+			if (count > 0 && encoding == Encoding::delta_packed)
+			{
+				if (!ColumnarLog::get_varint(in, end, raw))
+				{
+					return false;
+				}
+				value = static_cast<std::uint64_t>(ColumnarLog::unzigzag(raw));
+				out[row++] = static_cast<int>(static_cast<std::int64_t>(value));
+			}
+			if (count > 0 && (!ColumnarLog::get_varint(in, end, base) || in == end || *in > ColumnarLog::MAX_WIDTH))
+			{
+				return false;
+			}
+			if (count == 0)
+			{
+				return true;
+			}
+			base = static_cast<std::uint64_t>(ColumnarLog::unzigzag(base));
+			const int width = *in++;
+			ColumnarLog::BitReader bits{ in, end };
+			for (; row < count; ++row)
+			{
+				if (!bits.get(width, raw))
+				{
+					return false;
+				}
+				value = encoding == Encoding::packed ? base + raw : value + base + raw;
+				out[row] = static_cast<int>(static_cast<std::int64_t>(value));
+			}
+			return true;
+		}
+
+		case Encoding::run_length:
+			for (std::size_t row = 0; row < count; )
+			{
+				std::uint64_t length = 0;
+				if (!ColumnarLog::get_varint(in, end, raw) || !ColumnarLog::get_varint(in, end, length) || length >= count - row)
+				{
+					return false;
+				}
+				value += static_cast<std::uint64_t>(ColumnarLog::unzigzag(raw));
+				std::fill(out.begin() + row, out.begin() + row + static_cast<std::size_t>(length) + 1, static_cast<int>(static_cast<std::int64_t>(value)));
+				row += static_cast<std::size_t>(length) + 1;
+			}
+			return true;
+
+		case Encoding::delta_run_length:
+		{
+			std::uint64_t delta = 0;
+			if (count > 0)
+			{
+				if (!ColumnarLog::get_varint(in, end, raw))
+				{
+					return false;
+				}
+				value = static_cast<std::uint64_t>(ColumnarLog::unzigzag(raw));
+				out[0] = static_cast<int>(static_cast<std::int64_t>(value));
+			}
+			for (std::size_t row = 1; row < count; )
+			{
+				std::uint64_t length = 0;
+				if (!ColumnarLog::get_varint(in, end, raw) || !ColumnarLog::get_varint(in, end, length) || length >= count - row)
+				{
+					return false;
+				}
+				delta += static_cast<std::uint64_t>(ColumnarLog::unzigzag(raw));
+				for (std::size_t last = row + static_cast<std::size_t>(length); row <= last; ++row)
+				{
+					value += delta;
+					out[row] = static_cast<int>(static_cast<std::int64_t>(value));
+				}
+			}
+			return true;
+		}
+
+		default:
+			return false;
+		}
+	}
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_set>
+
+namespace DC
+{
+	class Node;
+
+	//How a sensor picks the sink for a new reading
+	enum class DestinationPolicy
+	{
+		random,			//Uniformly among the sinks
+		nearest,		//The sink fewest hops away over the physical neighbor graph
+		least_loaded,	//The sink with the fewest readings addressed to it and not yet delivered or dropped; ties go to the nearest
+		anycast			//Addressed to the nearest sink, but delivered at the first sink it reaches
+	};
+
+	inline bool parse_destination_policy(std::string const& name, DestinationPolicy& policy)
+	{
+		static const char* const names[] = { "random", "nearest", "least_loaded", "anycast" };
+		for (int ndx = 0; ndx < 4; ++ndx)
+		{
+			if (name == names[ndx])
+			{
+				policy = static_cast<DestinationPolicy>(ndx);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/*
+	 *	The destination policy of an Environment, shared by its nodes, so it works the same under every algorithm.
+	 *	The nearest sink of every node comes from one multi-source BFS from all sinks at once, over the topology's
+	 *	neighbor rows (node index i is the node labelled i + 1); the random policy keeps Node's own draw and needs none of it.
+	 */
+	class DestinationSelector
+	{
+	public:
+		using Index				= std::uint32_t;
+		static constexpr Index	NONE = 0xFFFFFFFF;
+
+		//offsets and neighbors are CSR rows as in Topology; sinks[slot] is the node at index sink_indices[slot]
+		inline void				reset(DestinationPolicy policy, std::vector<Index> const& offsets, std::vector<Index> const& neighbors,
+									std::vector<Node*> const& sinks, std::vector<Index> const& sink_indices);
+
+		DestinationPolicy		policy() const								{ return policy_; }
+		bool					anycast() const								{ return policy_ == DestinationPolicy::anycast; }
+		bool					is_sink(Index node) const					{ return sink_slot_[node] != NONE; }
+		//Hops from node to its nearest sink, NONE if it cannot reach one
+		Index					sink_hops(Index node) const					{ return hops_[node]; }
+
+		inline Node*			choose(Index node);
+		//Whether a reading (by message label) arriving at sink counts as delivered; under anycast only its first
+		//arrival at any sink does, since algorithms that flood copies may bring it to several
+		inline bool				on_delivered(Index sink, int label);
+		//A reading (by message label) addressed to destination was dropped somewhere on the way
+		inline void				on_dropped(Index destination, int label);
+
+	private:
+		inline void				release(Index sink, int label);
+
+		DestinationPolicy		policy_ = DestinationPolicy::random;
+		std::vector<Node*>		sinks_;				//By slot
+		std::vector<Index>		sink_slot_;			//By node index, NONE for other nodes
+		std::vector<Index>		nearest_;			//By node index: the slot of the nearest sink
+		std::vector<Index>		hops_;				//By node index
+		std::vector<std::int64_t> outstanding_;		//By slot: readings addressed to the sink and not yet delivered or dropped
+		std::unordered_set<int>	settled_;			//Labels of the readings delivered so far under anycast, or delivered or dropped under least_loaded
+	};
+
+	inline void DestinationSelector::reset(DestinationPolicy policy, std::vector<Index> const& offsets, std::vector<Index> const& neighbors,
+		std::vector<Node*> const& sinks, std::vector<Index> const& sink_indices)
+	{
+		const std::size_t node_count = offsets.size() - 1;
+		policy_ = policy;
+		sinks_ = sinks;
+		outstanding_.assign(sinks.size(), 0);
+		settled_.clear();
+		sink_slot_.assign(node_count, Index(NONE));
+		nearest_.assign(node_count, Index(NONE));
+		hops_.assign(node_count, Index(NONE));
+
+		//Every sink starts the BFS at once, so a node is reached first from its nearest sink (the lower slot on ties)
+		std::vector<Index> frontier;
+		frontier.reserve(node_count);
+		for (Index slot = 0; slot < sink_indices.size(); ++slot)
+		{
+			const Index sink = sink_indices[slot];
+			sink_slot_[sink] = slot;
+			nearest_[sink] = slot;
+			hops_[sink] = 0;
+			frontier.push_back(sink);
+		}
+		for (std::size_t head = 0; head < frontier.size(); ++head)
+		{
+			const Index node = frontier[head];
+			for (Index ndx = offsets[node]; ndx < offsets[node + 1]; ++ndx)
+			{
+				const Index other = neighbors[ndx];
+				if (hops_[other] == NONE)
+				{
+					hops_[other] = hops_[node] + 1;
+					nearest_[other] = nearest_[node];
+					frontier.push_back(other);
+				}
+			}
+		}
+	}
+
+	inline Node* DestinationSelector::choose(Index node)
+	{
+		//A node that reaches no sink keeps the first one; its readings are lost either way
+		Index slot = nearest_[node] != NONE ? nearest_[node] : 0;
+		if (policy_ == DestinationPolicy::least_loaded)
+		{
+			for (Index other = 0; other < outstanding_.size(); ++other)
+			{
+				if (outstanding_[other] < outstanding_[slot])
+				{
+					slot = other;
+				}
+			}
+			++outstanding_[slot];
+		}
+		return sinks_[slot];
+	}
+
+	inline bool DestinationSelector::on_delivered(Index sink, int label)
+	{
+		if (policy_ == DestinationPolicy::least_loaded)
+		{
+			release(sink, label);
+			return true;
+		}
+		return policy_ != DestinationPolicy::anycast || settled_.insert(label).second;
+	}
+
+	inline void DestinationSelector::on_dropped(Index destination, int label)
+	{
+		if (policy_ == DestinationPolicy::least_loaded)
+		{
+			release(destination, label);
+		}
+	}
+
+	inline void DestinationSelector::release(Index sink, int label)
+	{
+		//Algorithms that flood copies may deliver or drop a reading several times; only the first of either releases it,
+		//so a copy dropped while another is still on its way releases the reading early rather than twice
+		if (sink_slot_[sink] != NONE && settled_.insert(label).second)
+		{
+			--outstanding_[sink_slot_[sink]];
+		}
+	}
+}
@@ -2,8 +2,16 @@
 #include<vector>
 #include<fstream>
 #include<iostream>
+#include<algorithm>
+#include<climits>
 #include "node.hpp"
 #include "algorithm_base.h"
+#include "sensor_calendar.h"
+#include "profiler.h"
+#include "queue_monitor.h"
+#include "topology.h"
+#include "scenario.h"
+#include "load_field.h"
 
 namespace DC
 {
@@ -13,16 +21,33 @@ namespace DC
 		using NodeUnqPtr		= std::unique_ptr<Node>;
 		using NodeVector		= std::vector<NodeUnqPtr>;
 	public:
-		inline					Environment(AlgorithmBase& algorithm, int node_distance, int x_dim, int y_dim, int actuator_count, int comm_range, int sensor_period, int high_load_sensor_period, std::string file_name);
+		inline					Environment(AlgorithmBase& algorithm, int node_distance, int x_dim, int y_dim, int actuator_count, int comm_range, int sensor_period, int high_load_sensor_period, std::string file_name, unsigned seed = 15);
+		inline					Environment(AlgorithmBase& algorithm, Topology::Ptr topology, int sensor_period, int high_load_sensor_period, std::string file_name, unsigned seed = 15);
+		//Readings per 1000 ticks a sensor at (x, y) takes right now
 		int						get_sensory_probability(int x, int y);
+		//The sensor period at (x, y) right now
 		int						get_sensor_period(int x, int y);
 		void					run_timesteps(int update_timeframe, int loop_count);
 		void update_stats();
 		void run_messages(int update_timeframe, int message_count);
 		void					print_layout();
+		void					stream_log(bool arrival_only = false, std::size_t chunk_entries = 4096, std::size_t max_chunks = 16, LogFormat format = LogFormat::tsv);
+		void					monitor_queues(int sample_period, std::size_t capacity = 4096, std::size_t window = 16);
+		void					bound_queues(QueueLimits const& limits);
+		void					set_destination_policy(DestinationPolicy policy);
+		//Replaces the built-in high-load toggle of run_timesteps with a schedule of sensor periods by region;
+		//the field must be built for this Environment's topology, and can be shared with other Environments on it
+		void					set_load_field(LoadField::Ptr field);
+		void					set_load_zones(std::vector<LoadZone> zones)	{ set_load_field(std::make_shared<const LoadField>(std::move(zones), *topology_)); }
+		void					disable_log()							{ log_enabled_ = false; }
+		void					report_to(std::ostream& os)				{ report_ = &os; }
+		RunSummary const&		summary() const							{ return summary_; }
 	private:
 		AlgorithmBase*			algorithm_;
+		Topology::Ptr			topology_;
 		NodeVector				nodes_;
+		NeighborTable			neighbor_table_;
+		DestinationSelector		destination_selector_;
 		std::vector<Node*>		destinations_;
 
 		int						x_dim_;
@@ -33,121 +58,140 @@ namespace DC
 
 		std::string				file_name_;
 
+		SensorCalendar			sensor_calendar_;
+		std::vector<int>		due_sensors_;
+		std::vector<char>		sensing_now_;
+		int						current_time_ = 0;
+		RunStats				stats_;
+		RunSummary				summary_;
+		SimRandom				random_;
+		std::ostream*			report_ = &std::cout;
+
+		bool					log_enabled_ = true;
+		bool					stream_log_ = false;
+		bool					log_arrival_only_ = false;
+		std::size_t				log_chunk_entries_ = 0;
+		std::size_t				log_max_chunks_ = 0;
+		LogFormat				log_format_ = LogFormat::tsv;
+
+		QueueMonitor			queue_monitor_;
+
+		LoadField::Ptr			load_field_;
+		std::vector<int>		cell_periods_;			//By load field cell, as of the phases applied so far
+		std::size_t				next_phase_ = 0;
+
 		bool					partitioned();
 		void					print_nodes();
 		void					change_load(int new_sensor_period);
+		void					reset_load_field();
+		void					apply_load_field(int time);
+		int						next_load_change() const;
+		void					init_sensor_calendar();
+		void					collect_sensing(int time);
+		void					clear_sensing();
+		bool					network_idle(std::vector<Node*> const& active_nodes);
+		void					fast_forward(int tick_count);
+		void					init_queue_monitor();
+		void					sample_queues(int time);
+		std::int64_t			backlog();
+		void					finish_summary(int ticks);
+		void					open_log();
+		void					write_log();
 	};
 
-	inline Environment::Environment(AlgorithmBase& algorithm, int node_distance, int x_dim, int y_dim, int actuator_count, int comm_range, int sensor_period, int high_load_sensor_period, std::string file_name):
-		algorithm_{ &algorithm }, x_dim_(x_dim), y_dim_(y_dim), sensor_period_{ sensor_period }, high_load_sensor_period_{ high_load_sensor_period }, file_name_(file_name)
+	inline Environment::Environment(AlgorithmBase& algorithm, int node_distance, int x_dim, int y_dim, int actuator_count, int comm_range, int sensor_period, int high_load_sensor_period, std::string file_name, unsigned seed):
+		Environment(algorithm, Topology::grid(node_distance, x_dim, y_dim, actuator_count, comm_range), sensor_period, high_load_sensor_period, file_name, seed)
 	{
 		assert(node_distance <= comm_range);
-		std::srand(15);  // NOLINT(cert-msc51-cpp)
-		int node_count = 0; //Number of nodes
-
-		for (int x = 0; x < x_dim; x += node_distance)
-		{
-			for (int y = 0; y < y_dim; y += node_distance)
-			{
-				bool has_sensor = (node_count >= actuator_count);
-				bool is_active = true;
+	}
 
-				NodeUnqPtr node = std::make_unique<Node>(node_count + 1, x, y, has_sensor, is_active, *algorithm_, MSG_SEND_COST * 1000, sensor_period);
-				nodes_.push_back(std::move(node));
+	inline Environment::Environment(AlgorithmBase& algorithm, Topology::Ptr topology, int sensor_period, int high_load_sensor_period, std::string file_name, unsigned seed):
+		algorithm_{ &algorithm }, topology_(std::move(topology)), x_dim_(topology_->x_dim()), y_dim_(topology_->y_dim()), sensor_period_{ sensor_period },
+		high_load_sensor_period_{ high_load_sensor_period }, file_name_(file_name)
+	{
+		//Only the mutable per-node state is created here; positions, actuators and neighbors come from the shared topology
+		random_.seed(seed);
+		const int node_count = static_cast<int>(topology_->size());
+		nodes_.reserve(node_count);
 
-				++node_count;
-			}
+		for (int ndx = 0; ndx < node_count; ++ndx)
+		{
+			coordinates const& position = topology_->position(ndx);
+			bool has_sensor = !topology_->is_actuator(ndx);
+			bool is_active = true;
+
+			NodeUnqPtr node = std::make_unique<Node>(ndx + 1, position.x_, position.y_, has_sensor, is_active, *algorithm_, MSG_SEND_COST * 1000, sensor_period);
+			node->stats_ = &stats_;
+			node->random_ = &random_;
+			nodes_.push_back(std::move(node));
 		}
 
-		assert(actuator_count < node_count);
+		//Room is reserved for the physical neighbors, so only neighbors learned later ever grow a row
+		std::vector<Node*> node_ptrs(node_count);
+		for (int ndx = 0; ndx < node_count; ++ndx)
+		{
+			node_ptrs[ndx] = nodes_[ndx].get();
+			nodes_[ndx]->neighbor_table_ = &neighbor_table_;
+			nodes_[ndx]->destination_selector_ = &destination_selector_;
+		}
+		neighbor_table_.reset(std::move(node_ptrs), topology_->offsets());
 
-		for (int act_ndx = 0; act_ndx < actuator_count; ++act_ndx)
+		for (Topology::Index actuator : topology_->actuators())
 		{
-			destinations_.push_back(&(*nodes_[act_ndx]));
-			nodes_[act_ndx]->has_sensor_ = false;
+			destinations_.push_back(nodes_[actuator].get());
 		}
 
 		for (int i = 0; i < node_count; ++i)
 		{
-			for (int act_ndx = 0; act_ndx < actuator_count; ++act_ndx)
+			for (Node* destination : destinations_)
 			{
-				nodes_[i]->add_destination(*nodes_[act_ndx]);
+				nodes_[i]->add_destination(*destination);
 			}
 			algorithm_->on_node_init(nodes_[i].get());
 		}
 
-		for(auto& srcNode : nodes_)
+		for (int i = 0; i < node_count; ++i)
 		{
-			int const label = srcNode->label();
-
-			for (auto& destNode : nodes_)
+			for (Topology::Index const* neighbor = topology_->neighbors_begin(i); neighbor != topology_->neighbors_end(i); ++neighbor)
 			{
-				if(&srcNode != &destNode)
-				{
-					if(srcNode->distance_to(*destNode) <= comm_range)
-					{
-						srcNode->add_neighbor(*destNode);
-					}
-				}
+				nodes_[i]->add_neighbor(*nodes_[*neighbor]);
 			}
 		}
 	}
 
 	inline int Environment::get_sensor_period(int x, int y)
 	{
-		return 200;
-		const int probs_x_dim = 10;
-		const int probs_y_dim = 10;
-		int probs[probs_x_dim][probs_y_dim];
-
-		for (int i = 0; i < probs_x_dim; ++i)
-			for (int j = 0; j < probs_y_dim; ++j)
-			{
-				if (i > 2 && i < 5 && j > 2 && j < 5)
-				{
-					probs[i][j] = 10;
-				}
-				else
-				{
-					probs[i][j] = 2;
-				}
-			}
-
-		int probs_x_coor = (int)(x * probs_x_dim / x_dim_);
-		int probs_y_coor = (int)(x * probs_y_dim / y_dim_);
-		return probs[probs_x_coor][probs_y_coor];
+		if (!load_field_)
+		{
+			return sensor_period_;
+		}
+		const int period = cell_periods_[load_field_->cell_at(x, y)];
+		return period != LoadField::DEFAULT ? period : sensor_period_;
 	}
 
 	inline int Environment::get_sensory_probability(int x, int y)
 	{
-		const int probs_x_dim = 10;
-		const int probs_y_dim = 10;
-		int probs[probs_x_dim][probs_y_dim];
-
-		for (int i = 0; i < probs_x_dim; ++i)
-			for (int j = 0; j < probs_y_dim; ++j)
-			{
-				if (i > 2 && i < 5 && j > 2 && j < 5)
-				{
-					probs[i][j] = 50;
-				}
-				else
-				{
-					probs[i][j] = 10;
-				}
-			}
-
-		int probs_x_coor = (int)(x * probs_x_dim / x_dim_);
-		int probs_y_coor = (int)(x * probs_y_dim / y_dim_);
-		return probs[probs_x_coor][probs_y_coor];
+		return 1000 / get_sensor_period(x, y);
 	}
 
 	inline void Environment::run_timesteps(int update_timeframe, int loop_count)
 	{
 		int load_change_period = loop_count / 3;
+		init_sensor_calendar();
+		init_queue_monitor();
+		reset_load_field();
+		stats_.reset();
+		summary_ = RunSummary();
+		open_log();
+#if WSN_PROFILE
+		Profiler::current().reset();
+#endif
 
 		for (int i = 0; i < loop_count; i++)
 		{
+			WSN_PROFILE_SCOPE(environment);
+			WSN_PROFILE_COUNT(ticks);
+			current_time_ = i;
 			std::vector<Node*> node_list;
 			for (auto& node : nodes_)
 			{
@@ -156,38 +200,55 @@ namespace DC
 					node_list.push_back(&(*node));
 				}
 			}
-			algorithm_->on_tick(node_list, node_list.back()->destinations());
+			{
+				WSN_PROFILE_SCOPE(on_tick);
+				algorithm_->on_tick(node_list, node_list.back()->destinations());
+			}
 
-			for (auto& node : nodes_)
+			apply_load_field(i);
+			collect_sensing(i);
+			for (std::size_t ndx = 0; ndx < nodes_.size(); ++ndx)
 			{
-				bool sensed = (i + node->label()) % node->sensor_period_ == 0;
+				auto& node = nodes_[ndx];
+				bool sensed = sensing_now_[ndx] != 0;
 				sensed = sensed && node->has_sensor();
 				node->tick(sensed);
 			}
+			clear_sensing();
+			sample_queues(i);
+			if (i == loop_count / 2)
+			{
+				summary_.created_mid_ = stats_.totals_.created_;
+				summary_.backlog_mid_ = backlog();
+			}
+			if (i + 1 == loop_count)
+			{
+				summary_.created_end_ = stats_.totals_.created_;
+				summary_.backlog_end_ = backlog();
+			}
 			if (i % update_timeframe == 0)
 			{
 				update_stats();
 			}
 
-			if((i + 1) % load_change_period == 0)
+			if((i + 1) % load_change_period == 0 && !load_field_)
 			{
 				int new_sensor_period = under_increased_load ? sensor_period_ : high_load_sensor_period_;
 				change_load(new_sensor_period);
 				under_increased_load = !under_increased_load;
 			}
 		}
+		current_time_ = loop_count;
+		update_stats();
+		finish_summary(loop_count);
 		print_nodes();
 		//std::cout << "Sent Message Total: " << num_messages_created << "; Arrived Message Total: " << num_messages_arrived << std::endl;
 
-		std::ofstream file{ file_name_ };
-
-		//algorithm_->on_end(std::cout);
-		algorithm_->on_end(file);
+		write_log();
 	}
 
 	inline void Environment::update_stats()
 	{
-		std::cout << "Print the Update Here" << std::endl;
 		/*
 		 * Update Statistics:
 		 *	Total number of Messages created
@@ -195,9 +256,11 @@ namespace DC
 		 *	Total number of messages received
 		 *	Total number of messages arrived at destination
 		 *	For the messages that arrived since the last update:
+		 *		Delivery ratio
 		 *		Average hop count
-		 *		Average num_timesteps between sending and delivery
+		 *		Average num_timesteps between sending and delivery, with percentiles
 		 */
+		stats_.report(*report_, current_time_);
 	}
 
 	inline void Environment::run_messages(int update_timeframe, int message_count)
@@ -207,8 +270,20 @@ namespace DC
 		int cooldown_timer = 0;
 		int max_cooldown = 5000;
 		int i = 0;
+		init_sensor_calendar();
+		init_queue_monitor();
+		reset_load_field();
+		stats_.reset();
+		summary_ = RunSummary();
+		open_log();
+#if WSN_PROFILE
+		Profiler::current().reset();
+#endif
 		while (num_messages_arrived < message_count && cooldown_timer < max_cooldown)
 		{
+			WSN_PROFILE_SCOPE(environment);
+			WSN_PROFILE_COUNT(ticks);
+			current_time_ = i;
 			std::vector<Node*> node_list;
 			for (auto& node : nodes_)
 			{
@@ -217,37 +292,165 @@ namespace DC
 					node_list.push_back(&(*node));
 				}
 			}
-			algorithm_->on_tick(node_list, node_list.back()->destinations());
+			{
+				WSN_PROFILE_SCOPE(on_tick);
+				algorithm_->on_tick(node_list, node_list.back()->destinations());
+			}
 
-			for (auto& node : nodes_)
+			apply_load_field(i);
+			collect_sensing(i);
+			for (std::size_t ndx = 0; ndx < nodes_.size(); ++ndx)
 			{
+				auto& node = nodes_[ndx];
 				int prev_msg_recvd = node->recv_msg_count;
-				bool sensed = (i + node->label()) % node->sensor_period_ == 0;
+				bool sensed = sensing_now_[ndx] != 0;
 				sensed = sensed && node->has_sensor() && num_messages_created < message_count;
 				node->tick(sensed);
 				num_messages_created += sensed ? 1 : 0;
+				if (sensed && num_messages_created == message_count / 2)
+				{
+					summary_.created_mid_ = num_messages_created;
+					summary_.backlog_mid_ = backlog();
+				}
+				if (sensed && num_messages_created == message_count)
+				{
+					summary_.created_end_ = num_messages_created;
+					summary_.backlog_end_ = backlog();
+				}
 				if (prev_msg_recvd < node->recv_msg_count)
 				{
 					num_messages_arrived += node->recv_msg_count - prev_msg_recvd;
 					cooldown_timer = 0;
 				}
 			}
+			clear_sensing();
+			sample_queues(i);
 
 			if (i % update_timeframe == 0)
-				{
-					//update_stats();
-					//std::cout << "Time = " << i << ", Sent Message Total: " << num_messages_created << "; Arrived Message Total: " << num_messages_arrived << std::endl;
-				}
+			{
+				update_stats();
+			}
 			if (num_messages_created >= message_count)
 			{
 				//	This ensures that we don't loop infinitely if messages are lost
 				//	Once the max number of messages are in play, there is a limit on how much longer the simulation can run
 				cooldown_timer++; 
 			}
+			if (num_messages_arrived < message_count && cooldown_timer < max_cooldown && network_idle(node_list))
+			{
+				//	Nothing is in flight, so every tick until the next sensor activation would be empty
+				int skipped = 0;
+				if (num_messages_created >= message_count)
+				{
+					//	No more messages will be created, so nothing can arrive anymore; run out the cooldown
+					skipped = max_cooldown - cooldown_timer;
+				}
+				else if (sensor_calendar_.next_event() != SensorCalendar::NO_EVENT)
+				{
+					skipped = sensor_calendar_.next_event() - (i + 1);
+				}
+				//	Stop at the next stats update so the time series keeps its spacing, and before the load changes
+				skipped = std::min(skipped, update_timeframe - (i % update_timeframe) - 1);
+				if (next_load_change() != SensorCalendar::NO_EVENT)
+				{
+					skipped = std::min(skipped, next_load_change() - (i + 1));
+				}
+				if (num_messages_created >= message_count)
+				{
+					cooldown_timer += skipped;
+				}
+				fast_forward(skipped);
+				queue_monitor_.zero_frames(i + 1, i + skipped); //Every queue is empty while idle
+				i += skipped;
+			}
 			++i;
 		}
+		current_time_ = i;
+		update_stats();
+		finish_summary(i);
 		print_nodes();
-		std::cout << "Sent Message Total: " << num_messages_created << "; Arrived Message Total: " << num_messages_arrived << std::endl;
+		*report_ << "Sent Message Total: " << num_messages_created << "; Arrived Message Total: " << num_messages_arrived << std::endl;
+
+		write_log();
+	}
+
+	inline void Environment::stream_log(bool arrival_only, std::size_t chunk_entries, std::size_t max_chunks, LogFormat format)
+	{
+		//Hop entries are written to file_name_ by a background thread during the run instead of being kept until the end
+		stream_log_ = true;
+		log_arrival_only_ = arrival_only;
+		log_chunk_entries_ = chunk_entries;
+		log_max_chunks_ = max_chunks;
+		log_format_ = format;
+	}
+
+	inline void Environment::monitor_queues(int sample_period, std::size_t capacity, std::size_t window)
+	{
+		//Queue depths are sampled every sample_period ticks and written next to the hop log at the end of a run
+		queue_monitor_.configure(sample_period, capacity, window);
+	}
+
+	inline void Environment::bound_queues(QueueLimits const& limits)
+	{
+		for (auto& node : nodes_)
+		{
+			node->inbox_.set_capacity(limits.inbox_, limits.policy_);
+			node->outbox_.set_capacity(limits.outbox_, limits.policy_);
+			algorithm_->bound_queue(node.get(), limits.algorithm_, limits.policy_);
+		}
+	}
+
+	inline void Environment::set_destination_policy(DestinationPolicy policy)
+	{
+		destination_selector_.reset(policy, topology_->offsets(), topology_->neighbors(), destinations_, topology_->actuators());
+	}
+
+	inline void Environment::open_log()
+	{
+		algorithm_->logger_.set_enabled(log_enabled_);
+		if (!log_enabled_)
+		{
+			return;
+		}
+		if (stream_log_)
+		{
+			algorithm_->logger_.open(file_name_, log_arrival_only_, log_chunk_entries_, log_max_chunks_, log_format_);
+		}
+	}
+
+	inline void Environment::write_log()
+	{
+#if WSN_PROFILE
+		std::ofstream profile{ file_name_ + ".profile.json" };
+		Profiler::current().write_json(profile);
+#endif
+
+		if (queue_monitor_.enabled())
+		{
+			std::ofstream series{ file_name_ + ".queues.tab" };
+			queue_monitor_.write_series(series);
+			std::ofstream heatmap{ file_name_ + ".queue_heatmap.tab" };
+			queue_monitor_.write_heatmap(heatmap);
+			std::ofstream summary{ file_name_ + ".queue_nodes.tab" };
+			queue_monitor_.write_nodes(summary);
+		}
+
+		if (!log_enabled_)
+		{
+			std::ostream discard{ nullptr };
+			algorithm_->on_end(discard);
+			return;
+		}
+
+		if (algorithm_->logger_.streaming())
+		{
+			std::ostream discard{ nullptr };
+			algorithm_->on_end(discard);
+			algorithm_->logger_.close();
+			summary_.log_stalls_ = static_cast<std::int64_t>(algorithm_->logger_.stalls());
+			*report_ << "Log writer stalls: " << summary_.log_stalls_ << std::endl;
+			return;
+		}
 
 		std::ofstream file{ file_name_ };
 
@@ -255,6 +458,100 @@ namespace DC
 		algorithm_->on_end(file);
 	}
 
+	inline bool Environment::network_idle(std::vector<Node*> const& active_nodes)
+	{
+		if (!algorithm_->quiescent(active_nodes))
+		{
+			return false;
+		}
+
+		for (Node* node : active_nodes)
+		{
+			if (!node->queues_empty())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline void Environment::fast_forward(int tick_count)
+	{
+		if (tick_count <= 0)
+		{
+			return;
+		}
+
+		for (auto& node : nodes_)
+		{
+			node->skip_ticks(tick_count);
+		}
+		//Once every message is created the cooldown may skip past sensor triggers, which would be due in the past on resuming
+		sensor_calendar_.skip_to(current_time_ + tick_count + 1);
+	}
+
+	inline void Environment::init_queue_monitor()
+	{
+		std::vector<QueueMonitor::NodeInfo> info(nodes_.size());
+		for (std::size_t ndx = 0; ndx < nodes_.size(); ++ndx)
+		{
+			Node& node = *nodes_[ndx];
+			info[ndx].label_ = node.label();
+			info[ndx].x_ = node.ed.location_.x_;
+			info[ndx].y_ = node.ed.location_.y_;
+			info[ndx].actuator_distance_ = INT_MAX;
+			for (Node* destination : destinations_)
+			{
+				info[ndx].actuator_distance_ = std::min(info[ndx].actuator_distance_, node.distance_to(*destination));
+			}
+		}
+		queue_monitor_.reset(info);
+	}
+
+	inline void Environment::sample_queues(int time)
+	{
+		if (!queue_monitor_.due(time))
+		{
+			return;
+		}
+
+		QueueSample* frame = queue_monitor_.begin_frame(time);
+		for (std::size_t ndx = 0; ndx < nodes_.size(); ++ndx)
+		{
+			Node* node = nodes_[ndx].get();
+			frame[ndx].inbox_ = QueueSample::clamp(node->inbox_depth());
+			frame[ndx].outbox_ = QueueSample::clamp(node->outbox_depth());
+			frame[ndx].algorithm_ = QueueSample::clamp(algorithm_->queue_depth(node));
+		}
+		queue_monitor_.end_frame();
+	}
+
+	inline std::int64_t Environment::backlog()
+	{
+		std::int64_t queued = 0;
+		for (auto& node : nodes_)
+		{
+			queued += node->inbox_depth() + node->outbox_depth() + algorithm_->queue_depth(node.get());
+		}
+		return queued;
+	}
+
+	inline void Environment::finish_summary(int ticks)
+	{
+		summary_.ticks_ = ticks;
+		summary_.created_ = stats_.totals_.created_;
+		summary_.delivered_ = stats_.totals_.delivered_;
+		summary_.dropped_ = stats_.totals_.dropped_;
+		summary_.delivery_ratio_ = summary_.created_ ? static_cast<double>(summary_.delivered_) / summary_.created_ : 0.0;
+		summary_.avg_hops_ = summary_.delivered_ ? static_cast<double>(stats_.total_hops_) / summary_.delivered_ : 0.0;
+		summary_.avg_latency_ = summary_.delivered_ ? static_cast<double>(stats_.total_latency_) / summary_.delivered_ : 0.0;
+		summary_.energy_mA_ = 0;
+		for (auto& node : nodes_)
+		{
+			summary_.energy_mA_ += node->battery_used_mA_;
+		}
+	}
+
 	inline void Environment::print_layout()
 	{
 		const int node_count = static_cast<int>(nodes_.size());
@@ -273,16 +570,7 @@ namespace DC
 			std::cout << label << " : ";
 			for (auto& destNode : nodes_)
 			{
-				bool isNeighbor = false;
-				for(auto& neighbor : srcNode->neighbors_)
-				{
-					if(neighbor == destNode.get())
-					{
-						isNeighbor = true;
-						break;
-					}
-				}
-				if (isNeighbor)
+				if (srcNode->has_neighbor(*destNode))
 				{
 					std::cout << srcNode->distance_to(*destNode) << " ";
 				}
@@ -320,8 +608,9 @@ namespace DC
 	{
 		for (auto& node : nodes_)
 		{
-			std::cout << "Node " << node->label() << ": sent messages = " << node->sent_msg_count << ", received messages = " << node->inbox_msg_count <<
-				", generated messages = " << node->generated_msg_count_ << ", destination messages = " << node->recv_msg_count << std::endl;
+			*report_ << "Node " << node->label() << ": sent messages = " << node->sent_msg_count << ", received messages = " << node->inbox_msg_count <<
+				", generated messages = " << node->generated_msg_count_ << ", destination messages = " << node->recv_msg_count <<
+				", dropped messages = " << node->dropped_msg_count_ << std::endl;
 		}
 		// For each node, number of sent messages, number of received messages, and number of destination messages (messages that the node was the destination for)
 		// Have the node return a list of all destination messages
@@ -338,15 +627,89 @@ namespace DC
 		int max_x = x_dim_ * 2 / 3;
 		int max_y = y_dim_ * 2 / 3;
 
-		for(auto&& node : nodes_)
+		for (std::size_t ndx = 0; ndx < nodes_.size(); ++ndx)
 		{
+			auto& node = nodes_[ndx];
 			int node_x = node->ed.location_.x_;
 			int node_y = node->ed.location_.y_;
 
 			if(node_x > min_x && node_x <= max_x && node_y > min_y && node_y <= max_y)
 			{
 				node->sensor_period_ = new_sensor_period;
+				//The load changes after this tick has been processed, so the new period applies from the next one
+				sensor_calendar_.set_period(static_cast<int>(ndx), new_sensor_period, current_time_ + 1);
+			}
+		}
+	}
+
+	inline void Environment::set_load_field(LoadField::Ptr field)
+	{
+		assert(field);
+		load_field_ = std::move(field);
+		reset_load_field();
+	}
+
+	inline void Environment::reset_load_field()
+	{
+		next_phase_ = 0;
+		cell_periods_.assign(load_field_ ? load_field_->cell_count() : 0, int(LoadField::DEFAULT));
+	}
+
+	inline int Environment::next_load_change() const
+	{
+		return load_field_ && next_phase_ < load_field_->phase_count() ? load_field_->phase_time(next_phase_) : SensorCalendar::NO_EVENT;
+	}
+
+	inline void Environment::apply_load_field(int time)
+	{
+		//Phases that start on this tick take effect before its sensing; only the nodes of the cells they change are touched
+		for (; load_field_ && next_phase_ < load_field_->phase_count() && load_field_->phase_time(next_phase_) <= time; ++next_phase_)
+		{
+			for (auto change = load_field_->changes_begin(next_phase_); change != load_field_->changes_end(next_phase_); ++change)
+			{
+				cell_periods_[change->cell_] = change->period_;
+				const int period = change->period_ != LoadField::DEFAULT ? change->period_ : sensor_period_;
+				for (auto node = load_field_->nodes_begin(change->cell_); node != load_field_->nodes_end(change->cell_); ++node)
+				{
+					nodes_[*node]->sensor_period_ = period;
+					sensor_calendar_.set_period(static_cast<int>(*node), period, time);
+				}
+			}
+		}
+	}
+
+	inline void Environment::init_sensor_calendar()
+	{
+		const int node_count = static_cast<int>(nodes_.size());
+		sensor_calendar_.reset(node_count);
+		sensing_now_.assign(node_count, 0);
+		due_sensors_.clear();
+
+		for (int ndx = 0; ndx < node_count; ++ndx)
+		{
+			Node& node = *nodes_[ndx];
+			if (node.has_sensor())
+			{
+				sensor_calendar_.schedule(ndx, node.label(), node.sensor_period_, 0);
 			}
 		}
 	}
+
+	inline void Environment::collect_sensing(int time)
+	{
+		sensor_calendar_.pop_due(time, due_sensors_);
+		for (int ndx : due_sensors_)
+		{
+			sensing_now_[ndx] = 1;
+		}
+	}
+
+	inline void Environment::clear_sensing()
+	{
+		for (int ndx : due_sensors_)
+		{
+			sensing_now_[ndx] = 0;
+		}
+		due_sensors_.clear();
+	}
 }
@@ -0,0 +1,90 @@
+#pragma once
+#include <string>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include "message.hpp"
+
+namespace DC
+{
+	//What a fusion function has folded into one aggregate so far
+	struct FusionState
+	{
+		std::size_t				count_ = 0;
+		double					sum_ = 0;
+		double					max_ = std::numeric_limits<double>::lowest();
+		std::string				text_;
+	};
+
+	/*
+	 *	Decides what an aggregate of readings says and how many readings one aggregate can hold.
+	 *	The readings themselves always travel along inside the aggregate (Message::carry), so the destination still
+	 *	sees every one of them; the fused contents are what a real node would put on the air.
+	 *	Numeric fusions read a reading's contents as a number; non-numeric contents count as 0.
+	 */
+	class Fusion
+	{
+	public:
+		virtual					~Fusion() = default;
+
+		//Whether reading still fits into the aggregate; if not, the aggregate is sent and a new one started
+		virtual bool			fits(FusionState const& state, Message const& reading) const	{ return true; }
+		virtual void			add(FusionState& state, Message const& reading) const
+		{
+			const double value = std::atof(reading.contents().c_str());
+			++state.count_;
+			state.sum_ += value;
+			state.max_ = std::max(state.max_, value);
+		}
+		virtual std::string		contents(FusionState const& state) const = 0;
+	};
+
+	class CountFusion : public Fusion
+	{
+	public:
+		std::string				contents(FusionState const& state) const override	{ return std::to_string(state.count_); }
+	};
+
+	class SumFusion : public Fusion
+	{
+	public:
+		std::string				contents(FusionState const& state) const override	{ return std::to_string(state.sum_); }
+	};
+
+	class MeanFusion : public Fusion
+	{
+	public:
+		std::string				contents(FusionState const& state) const override	{ return std::to_string(state.count_ ? state.sum_ / state.count_ : 0.0); }
+	};
+
+	class MaxFusion : public Fusion
+	{
+	public:
+		std::string				contents(FusionState const& state) const override	{ return std::to_string(state.max_); }
+	};
+
+	//Joins the readings' contents with ';' into frames of at most frame_bytes (a longer single reading gets a frame of its own)
+	class ConcatFusion : public Fusion
+	{
+	public:
+		explicit				ConcatFusion(std::size_t frame_bytes = 1024) : frame_bytes_(frame_bytes) {}
+
+		bool					fits(FusionState const& state, Message const& reading) const override
+		{
+			return state.count_ == 0 || state.text_.size() + 1 + reading.contents().size() <= frame_bytes_;
+		}
+		void					add(FusionState& state, Message const& reading) const override
+		{
+			if (state.count_ != 0)
+			{
+				state.text_ += ';';
+			}
+			state.text_ += reading.contents();
+			Fusion::add(state, reading);
+		}
+		std::string				contents(FusionState const& state) const override	{ return state.text_; }
+
+	private:
+		std::size_t				frame_bytes_;
+	};
+}
@@ -0,0 +1,224 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <ostream>
+#include "hop_log_reader.h"
+#include "run_stats.h"
+
+namespace DC
+{
+	/*
+	 *	Per-file summary of a hop log, either the TSV written by Logger::print or the columnar binary layout.
+	 *	Heartbeats (destNode == -1) are ignored. A message counts as created once its label shows up with a
+	 *	destination, and as delivered once it has an arrival row; further arrival rows are duplicates.
+	 */
+	struct HopLogSummary
+	{
+		struct source_stats
+		{
+			std::int64_t	delivered_ = 0;
+			std::int64_t	latency_sum_ = 0;
+		};
+
+		std::string			file_;
+		bool				ok_ = false;
+		std::int64_t		rows_ = 0;
+		std::int64_t		created_ = 0;
+		std::int64_t		delivered_ = 0;
+		std::int64_t		duplicates_ = 0;
+		std::int64_t		hop_sum_ = 0;
+		std::int64_t		latency_sum_ = 0;
+		int					max_hops_ = 0;
+		int					max_latency_ = 0;
+		LatencySketch		hops_;
+		LatencySketch		latency_;
+		std::vector<source_stats> sources_;	//Indexed by srcNode label
+
+		double				delivery_ratio() const	{ return created_ ? static_cast<double>(delivered_) / created_ : 0.0; }
+		double				average_hops() const	{ return delivered_ ? static_cast<double>(hop_sum_) / delivered_ : 0.0; }
+		double				average_latency() const	{ return delivered_ ? static_cast<double>(latency_sum_) / delivered_ : 0.0; }
+	};
+
+	class HopLogAnalyzer
+	{
+	public:
+		static inline HopLogSummary					analyze_file(std::string const& file_name);
+		static inline std::vector<HopLogSummary>	analyze_files(std::vector<std::string> const& file_names, unsigned thread_count = 0);
+		static inline void							write_summary(std::ostream& os, std::vector<HopLogSummary> const& summaries);
+		static inline void							write_sources(std::ostream& os, std::vector<HopLogSummary> const& summaries);
+
+	private:
+		//Tracks which message labels were already created/delivered; bit 0 = created, bit 1 = delivered
+		struct accumulator
+		{
+			HopLogSummary&			summary_;
+			std::vector<std::uint8_t> seen_;
+
+			explicit accumulator(HopLogSummary& summary) : summary_(summary) {}
+			inline void				add(MessageHopLogEntry const& entry);
+		};
+	};
+
+	inline void HopLogAnalyzer::accumulator::add(MessageHopLogEntry const& entry)
+	{
+		++summary_.rows_;
+		const int msg_label = entry.msgLabel;
+		if (entry.destNode < 0 || msg_label < 0)
+		{
+			return;
+		}
+
+		if (static_cast<std::size_t>(msg_label) >= seen_.size())
+		{
+			seen_.resize(std::max<std::size_t>(static_cast<std::size_t>(msg_label) + 1, seen_.size() * 2), 0);
+		}
+		std::uint8_t& seen = seen_[msg_label];
+		if (!(seen & 1))
+		{
+			seen |= 1;
+			++summary_.created_;
+		}
+		if (!entry.arrival_hop)
+		{
+			return;
+		}
+		if (seen & 2)
+		{
+			++summary_.duplicates_;
+			return;
+		}
+		seen |= 2;
+
+		const int latency = entry.travelTime;
+		++summary_.delivered_;
+		summary_.hop_sum_ += entry.hopCount;
+		summary_.latency_sum_ += latency;
+		summary_.max_hops_ = std::max(summary_.max_hops_, entry.hopCount);
+		summary_.max_latency_ = std::max(summary_.max_latency_, latency);
+		summary_.hops_.add(entry.hopCount);
+		summary_.latency_.add(latency);
+
+		const int source = entry.srcNode;
+		if (source >= 0)
+		{
+			if (static_cast<std::size_t>(source) >= summary_.sources_.size())
+			{
+				summary_.sources_.resize(source + 1);
+			}
+			++summary_.sources_[source].delivered_;
+			summary_.sources_[source].latency_sum_ += latency;
+		}
+	}
+
+	inline HopLogSummary HopLogAnalyzer::analyze_file(std::string const& file_name)
+	{
+		HopLogSummary summary;
+		summary.file_ = file_name;
+		accumulator acc{ summary };
+		summary.ok_ = HopLogReader::for_each(file_name, [&acc](MessageHopLogEntry const& entry) { acc.add(entry); });
+		return summary;
+	}
+
+	inline std::vector<HopLogSummary> HopLogAnalyzer::analyze_files(std::vector<std::string> const& file_names, unsigned thread_count)
+	{
+		std::vector<HopLogSummary> summaries(file_names.size());
+		if (thread_count == 0)
+		{
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		thread_count = std::min<unsigned>(thread_count, static_cast<unsigned>(file_names.size()));
+
+		//Files are handed out one at a time so a few large files don't leave the other threads idle
+		std::atomic<std::size_t> next{ 0 };
+		auto worker = [&]()
+		{
+			for (std::size_t ndx = next++; ndx < file_names.size(); ndx = next++)
+			{
+				summaries[ndx] = analyze_file(file_names[ndx]);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned ndx = 1; ndx < thread_count; ++ndx)
+		{
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		return summaries;
+	}
+
+	inline void HopLogAnalyzer::write_summary(std::ostream& os, std::vector<HopLogSummary> const& summaries)
+	{
+		os << "file" << "\t";
+		os << "rows" << "\t";
+		os << "created" << "\t";
+		os << "delivered" << "\t";
+		os << "duplicates" << "\t";
+		os << "delivery_ratio" << "\t";
+		os << "avg_hops" << "\t";
+		os << "p50_hops" << "\t";
+		os << "p90_hops" << "\t";
+		os << "max_hops" << "\t";
+		os << "avg_latency" << "\t";
+		os << "p50_latency" << "\t";
+		os << "p90_latency" << "\t";
+		os << "p99_latency" << "\t";
+		os << "max_latency" << "\n";
+
+		for (auto& summary : summaries)
+		{
+			if (!summary.ok_)
+			{
+				std::cerr << "Could not analyze " << summary.file_ << std::endl;
+				continue;
+			}
+			os << summary.file_ << "\t";
+			os << summary.rows_ << "\t";
+			os << summary.created_ << "\t";
+			os << summary.delivered_ << "\t";
+			os << summary.duplicates_ << "\t";
+			os << summary.delivery_ratio() << "\t";
+			os << summary.average_hops() << "\t";
+			os << summary.hops_.quantile(0.5) << "\t";
+			os << summary.hops_.quantile(0.9) << "\t";
+			os << summary.max_hops_ << "\t";
+			os << summary.average_latency() << "\t";
+			os << summary.latency_.quantile(0.5) << "\t";
+			os << summary.latency_.quantile(0.9) << "\t";
+			os << summary.latency_.quantile(0.99) << "\t";
+			os << summary.max_latency_ << "\n";
+		}
+	}
+
+	inline void HopLogAnalyzer::write_sources(std::ostream& os, std::vector<HopLogSummary> const& summaries)
+	{
+		os << "file" << "\t";
+		os << "srcNode" << "\t";
+		os << "delivered" << "\t";
+		os << "avg_latency" << "\n";
+
+		for (auto& summary : summaries)
+		{
+			for (std::size_t source = 0; summary.ok_ && source < summary.sources_.size(); ++source)
+			{
+				auto& stats = summary.sources_[source];
+				if (stats.delivered_ == 0)
+				{
+					continue;
+				}
+				os << summary.file_ << "\t";
+				os << source << "\t";
+				os << stats.delivered_ << "\t";
+				os << static_cast<double>(stats.latency_sum_) / stats.delivered_ << "\n";
+			}
+		}
+	}
+}
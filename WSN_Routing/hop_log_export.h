@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ostream>
+#include "logger.h"
+#include "columnar_log.h"
+#include "mapped_file.h"
+
+namespace DC
+{
+	/*
+	 *	Converts a columnar hop log (Logger streaming with LogFormat::columnar) back into the TSV text that
+	 *	Logger::print writes, so the existing analysis keeps working. Returns false if the input can't be read.
+	 */
+	inline bool export_hop_log_tsv(std::string const& columnar_file, std::ostream& os, bool arrival_only = false)
+	{
+		MappedFile file{ columnar_file };
+		if (!file.is_open())
+		{
+			std::cerr << "Could not open " << columnar_file << std::endl;
+			return false;
+		}
+
+		ColumnarReader reader{ file.data(), file.size() };
+		if (!reader.valid())
+		{
+			std::cerr << columnar_file << " is not a columnar hop log" << std::endl;
+			return false;
+		}
+
+		MessageHopLogEntry::print_header(os);
+		std::vector<MessageHopLogEntry> entries;
+		std::vector<int> scratch;
+		std::string text;
+		while (reader.next_chunk())
+		{
+			if (!MessageHopLogEntry::read_columns(reader, entries, scratch))
+			{
+				std::cerr << columnar_file << " has a damaged chunk" << std::endl;
+				return false;
+			}
+			text.clear();
+			for (auto& entry : entries)
+			{
+				if (!arrival_only || entry.arrival_hop)
+				{
+					entry.append_tsv(text);
+				}
+			}
+			os.write(text.data(), static_cast<std::streamsize>(text.size()));
+		}
+		if (reader.damaged())
+		{
+			std::cerr << columnar_file << " has a damaged chunk" << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
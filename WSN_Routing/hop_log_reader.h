@@ -0,0 +1,196 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstring>
+#include "logger.h"
+#include "columnar_log.h"
+#include "mapped_file.h"
+
+namespace DC
+{
+	/*
+	 *	Reads a hop log written by Logger, either TSV or columnar, straight out of a memory mapping and hands every
+	 *	row to a visitor as a MessageHopLogEntry. Columns are matched by name; missing ones stay 0.
+	 *	Older logs without an arrival_hop column mark arrivals as the row read_msg writes: no hop destination and
+	 *	an endTime equal to the row's timestamp.
+	 */
+	class HopLogReader
+	{
+	public:
+		template<typename Visit>
+		static inline bool		for_each(std::string const& file_name, Visit visit);
+
+	private:
+		template<typename Visit>
+		static inline bool		scan_tsv(char const* data, std::size_t size, Visit& visit);
+		template<typename Visit>
+		static inline bool		scan_columnar(char const* data, std::size_t size, Visit& visit);
+
+		static void				infer_arrival(MessageHopLogEntry& entry)
+		{
+			entry.arrival_hop = entry.hopDest == -1 && entry.endTime != 0 && entry.endTime == entry.timestamp;
+		}
+
+		static void				assign(MessageHopLogEntry& entry, int column, int value)
+		{
+			//column is an index into MessageHopLogEntry::column_names()
+			switch (column)
+			{
+			case 0: entry.srcNode = value; break;
+			case 1: entry.destNode = value; break;
+			case 2: entry.hopSource = value; break;
+			case 3: entry.hopDest = value; break;
+			case 4: entry.msgLabel = value; break;
+			case 5: entry.timestamp = value; break;
+			case 6: entry.hopCount = value; break;
+			case 7: entry.startTime = value; break;
+			case 8: entry.endTime = value; break;
+			case 9: entry.arrival_hop = value != 0; break;
+			case 10: entry.travelTime = value; break;
+			case 11: entry.envelopeLabel = value; break;
+			default: break;
+			}
+		}
+	};
+
+	template<typename Visit>
+	inline bool HopLogReader::for_each(std::string const& file_name, Visit visit)
+	{
+		MappedFile file{ file_name };
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		const bool columnar = file.size() >= ColumnarLog::MAGIC_LENGTH &&
+			std::memcmp(file.data(), ColumnarLog::magic(), ColumnarLog::MAGIC_LENGTH) == 0;
+		return columnar ? scan_columnar(file.data(), file.size(), visit) : scan_tsv(file.data(), file.size(), visit);
+	}
+
+	template<typename Visit>
+	inline bool HopLogReader::scan_tsv(char const* data, std::size_t size, Visit& visit)
+	{
+		char const* p = data;
+		char const* const end = data + size;
+
+		//Header line gives the column positions
+		std::vector<std::string> names;
+		std::string name;
+		for (; p < end && *p != '\n'; ++p)
+		{
+			if (*p == '\t')
+			{
+				names.push_back(name);
+				name.clear();
+			}
+			else if (*p != '\r')
+			{
+				name.push_back(*p);
+			}
+		}
+		names.push_back(name);
+		if (p < end)
+		{
+			++p;
+		}
+
+		const std::vector<std::string> known = MessageHopLogEntry::column_names();
+		std::vector<int> field_column(names.size(), -1);
+		bool has_arrival = false;
+		int matched = 0;
+		for (std::size_t field = 0; field < names.size(); ++field)
+		{
+			for (std::size_t column = 0; column < known.size(); ++column)
+			{
+				if (names[field] == known[column])
+				{
+					field_column[field] = static_cast<int>(column);
+					has_arrival = has_arrival || known[column] == "arrival_hop";
+					++matched;
+				}
+			}
+		}
+		if (matched < 7)
+		{
+			return false; //Not a hop log
+		}
+
+		//Rows are plain integers separated by tabs. The digit loop has no data-dependent branches besides its
+		//exit, which keeps it tight.
+		const int field_count = static_cast<int>(names.size());
+		MessageHopLogEntry entry;
+		while (p < end)
+		{
+			entry = MessageHopLogEntry();
+			int field = 0;
+			while (p < end && *p != '\n')
+			{
+				const bool negative = *p == '-';
+				p += negative;
+				unsigned int value = 0;
+				char const* digits = p;
+				while (p < end && static_cast<unsigned char>(*p - '0') < 10)
+				{
+					value = value * 10 + static_cast<unsigned char>(*p - '0');
+					++p;
+				}
+				if (field < field_count)
+				{
+					assign(entry, field_column[field], negative ? -static_cast<int>(value) : static_cast<int>(value));
+				}
+				++field;
+				if (p == digits && p < end && *p != '\n' && *p != '\t' && *p != '\r')
+				{
+					++p; //Not a number; skip it so we always make progress
+				}
+				while (p < end && (*p == '\t' || *p == '\r'))
+				{
+					++p;
+				}
+			}
+			if (p < end)
+			{
+				++p;
+			}
+			if (field >= field_count)
+			{
+				if (!has_arrival)
+				{
+					infer_arrival(entry);
+				}
+				visit(static_cast<MessageHopLogEntry const&>(entry));
+			}
+		}
+		return true;
+	}
+
+	template<typename Visit>
+	inline bool HopLogReader::scan_columnar(char const* data, std::size_t size, Visit& visit)
+	{
+		ColumnarReader reader{ data, size };
+		if (!reader.valid())
+		{
+			return false;
+		}
+
+		const bool has_arrival = reader.column_index("arrival_hop") >= 0;
+		std::vector<MessageHopLogEntry> entries;
+		std::vector<int> scratch;
+		while (reader.next_chunk())
+		{
+			if (!MessageHopLogEntry::read_columns(reader, entries, scratch))
+			{
+				return false;
+			}
+			for (auto& entry : entries)
+			{
+				if (!has_arrival)
+				{
+					infer_arrival(entry);
+				}
+				visit(static_cast<MessageHopLogEntry const&>(entry));
+			}
+		}
+		return !reader.damaged();
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include "topology.h"
+#include "scenario.h"
+
+namespace DC
+{
+	/*
+	 *	The sensor periods that load zones put on the field, as a raster whose grid lines are the zone edges, so every
+	 *	cell is either wholly inside or wholly outside each zone. Built once per scenario and topology and shared
+	 *	(read-only) by every Environment of a sweep:
+	 *	-	every node's cell is looked up once, so a node's period is one array read;
+	 *	-	the zones are replayed up front into phases, one per distinct start tick, each listing only the cells whose
+	 *		period it changes, and every cell lists its nodes, so a phase updates just the affected nodes in one batch.
+	 *	A cell period of DEFAULT means the run's own default sensor period, so one field serves every period of a sweep.
+	 */
+	class LoadField
+	{
+	public:
+		using Index				= Topology::Index;
+		using Ptr				= std::shared_ptr<const LoadField>;
+		static constexpr int	DEFAULT = 0;
+
+		struct cell_change
+		{
+			Index				cell_ = 0;
+			int					period_ = DEFAULT;
+		};
+
+		inline					LoadField(std::vector<LoadZone> zones, Topology const& topology);
+
+		std::size_t				cell_count() const									{ return (x_cuts_.size() + 1) * (y_cuts_.size() + 1); }
+		Index					cell_of(Index node) const							{ return node_cell_[node]; }
+		Index					cell_at(int x, int y) const
+		{
+			const std::size_t column = std::upper_bound(x_cuts_.begin(), x_cuts_.end(), x) - x_cuts_.begin();
+			const std::size_t row = std::upper_bound(y_cuts_.begin(), y_cuts_.end(), y) - y_cuts_.begin();
+			return static_cast<Index>(column * (y_cuts_.size() + 1) + row);
+		}
+		Index const*			nodes_begin(Index cell) const						{ return cell_nodes_.data() + cell_start_[cell]; }
+		Index const*			nodes_end(Index cell) const							{ return cell_nodes_.data() + cell_start_[cell + 1]; }
+
+		std::size_t				phase_count() const									{ return phase_time_.size(); }
+		int						phase_time(std::size_t phase) const					{ return phase_time_[phase]; }
+		cell_change const*		changes_begin(std::size_t phase) const				{ return changes_.data() + phase_start_[phase]; }
+		cell_change const*		changes_end(std::size_t phase) const				{ return changes_.data() + phase_start_[phase + 1]; }
+
+	private:
+		std::vector<int>		x_cuts_;		//Column c covers [x_cuts_[c - 1], x_cuts_[c])
+		std::vector<int>		y_cuts_;
+		std::vector<Index>		node_cell_;		//By node index
+		std::vector<Index>		cell_start_;	//CSR of the nodes of every cell
+		std::vector<Index>		cell_nodes_;
+		std::vector<int>		phase_time_;
+		std::vector<Index>		phase_start_;	//CSR of the changes of every phase
+		std::vector<cell_change> changes_;
+	};
+
+	inline LoadField::LoadField(std::vector<LoadZone> zones, Topology const& topology)
+	{
+		for (auto const& zone : zones)
+		{
+			x_cuts_.push_back(zone.x0_);
+			x_cuts_.push_back(zone.x1_);
+			y_cuts_.push_back(zone.y0_);
+			y_cuts_.push_back(zone.y1_);
+		}
+		for (std::vector<int>* cuts : { &x_cuts_, &y_cuts_ })
+		{
+			std::sort(cuts->begin(), cuts->end());
+			cuts->erase(std::unique(cuts->begin(), cuts->end()), cuts->end());
+		}
+
+		//Bucket the nodes by cell (counting sort, so each cell lists its nodes in index order)
+		const std::size_t node_count = topology.size();
+		node_cell_.resize(node_count);
+		cell_start_.assign(cell_count() + 1, 0);
+		for (Index node = 0; node < node_count; ++node)
+		{
+			node_cell_[node] = cell_at(topology.position(node).x_, topology.position(node).y_);
+			++cell_start_[node_cell_[node] + 1];
+		}
+		for (std::size_t cell = 1; cell < cell_start_.size(); ++cell)
+		{
+			cell_start_[cell] += cell_start_[cell - 1];
+		}
+		cell_nodes_.resize(node_count);
+		std::vector<Index> fill(cell_start_.begin(), cell_start_.end() - 1);
+		for (Index node = 0; node < node_count; ++node)
+		{
+			cell_nodes_[fill[node_cell_[node]]++] = node;
+		}
+
+		//Replay the zones in start order (file order on ties, so later zones win) and keep what each start tick changed
+		std::stable_sort(zones.begin(), zones.end(), [](LoadZone const& a, LoadZone const& b) { return a.from_ < b.from_; });
+		const std::size_t rows = y_cuts_.size() + 1;
+		std::vector<int> period(cell_count(), int(DEFAULT));
+		std::vector<int> before(cell_count(), int(DEFAULT));
+		std::vector<Index> touched;
+		phase_start_.push_back(0);
+		for (std::size_t first = 0; first < zones.size(); )
+		{
+			std::size_t last = first;
+			touched.clear();
+			for (; last < zones.size() && zones[last].from_ == zones[first].from_; ++last)
+			{
+				LoadZone const& zone = zones[last];
+				const std::size_t column_end = cell_at(zone.x1_, zone.y1_) / rows;
+				const std::size_t row_end = cell_at(zone.x1_, zone.y1_) % rows;
+				for (std::size_t column = cell_at(zone.x0_, zone.y0_) / rows; column < column_end; ++column)
+				{
+					for (std::size_t row = cell_at(zone.x0_, zone.y0_) % rows; row < row_end; ++row)
+					{
+						const Index cell = static_cast<Index>(column * rows + row);
+						touched.push_back(cell);
+						period[cell] = zone.period_;
+					}
+				}
+			}
+
+			std::sort(touched.begin(), touched.end());
+			touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+			for (Index cell : touched)
+			{
+				if (period[cell] != before[cell])
+				{
+					cell_change change;
+					change.cell_ = cell;
+					change.period_ = period[cell];
+					changes_.push_back(change);
+					before[cell] = period[cell];
+				}
+			}
+			phase_time_.push_back(zones[first].from_);
+			phase_start_.push_back(static_cast<Index>(changes_.size()));
+			first = last;
+		}
+	}
+}
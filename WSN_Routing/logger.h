@@ -3,8 +3,43 @@
 #include<fstream>
 #include<string>
 #include<vector> 
+#include<memory>
+#include<thread>
+#include<atomic>
+#include<chrono>
+#include<cassert>
+#include "spsc_ring.h"
+#include "columnar_log.h"
+
+/*
+ *	Hop logging level, fixed at compile time (e.g. /D WSN_LOG_LEVEL=WSN_LOG_ARRIVALS):
+ *		WSN_LOG_OFF			nothing is logged
+ *		WSN_LOG_ARRIVALS	only the rows written when a message reaches its destination
+ *		WSN_LOG_SAMPLED		every row of one message in WSN_LOG_SAMPLE_RATE, chosen by message label
+ *		WSN_LOG_FULL		every hop (default)
+ *	Disabled levels compile down to nothing in Node. Logger::set_sample_rate can thin the log further at runtime.
+ */
+#define WSN_LOG_OFF			0
+#define WSN_LOG_ARRIVALS	1
+#define WSN_LOG_SAMPLED		2
+#define WSN_LOG_FULL		3
+
+#ifndef WSN_LOG_LEVEL
+#define WSN_LOG_LEVEL WSN_LOG_FULL
+#endif
+
+#ifndef WSN_LOG_SAMPLE_RATE
+#define WSN_LOG_SAMPLE_RATE 16
+#endif
 
 namespace DC{
+	struct LogPolicy
+	{
+		static constexpr bool	hops = WSN_LOG_LEVEL >= WSN_LOG_SAMPLED;
+		static constexpr bool	arrivals = WSN_LOG_LEVEL >= WSN_LOG_ARRIVALS;
+		static constexpr int	sample_rate = WSN_LOG_LEVEL == WSN_LOG_SAMPLED ? WSN_LOG_SAMPLE_RATE : 1;
+	};
+
 	struct MessageHopLogEntry
 	{
 		int srcNode = 0;
@@ -18,6 +53,7 @@ namespace DC{
 		int endTime = 0;
 		int travelTime = 0;
 		bool arrival_hop = false;
+		int envelopeLabel = 0;		//The aggregate carrying this message, or msgLabel itself
 
 		void print(std::ostream& os)
 		{
@@ -31,7 +67,128 @@ namespace DC{
 			os << startTime << "\t";
 			os << endTime << "\t";
 			os << arrival_hop << "\t";
-			os << travelTime << "\n";
+			os << travelTime << "\t";
+			os << envelopeLabel << "\n";
+		}
+
+		static void print_header(std::ostream& os)
+		{
+			os << "srcNode" << "\t";
+			os << "destNode" << "\t";
+			os << "hopSource" << "\t";
+			os << "hopDest" << "\t";
+			os << "msgLabel" << "\t";
+			os << "timestamp" << "\t";
+			os << "hopCount" << "\t";
+			os << "startTime" << "\t";
+			os << "endTime" << "\t";
+			os << "arrival_hop" << "\t";
+			os << "travelTime" << "\t";
+			os << "envelopeLabel" << "\n";
+		}
+
+		//Same text as print(), formatted without going through the stream for every field
+		void append_tsv(std::string& out) const
+		{
+			append_int(out, srcNode, '\t');
+			append_int(out, destNode, '\t');
+			append_int(out, hopSource, '\t');
+			append_int(out, hopDest, '\t');
+			append_int(out, msgLabel, '\t');
+			append_int(out, timestamp, '\t');
+			append_int(out, hopCount, '\t');
+			append_int(out, startTime, '\t');
+			append_int(out, endTime, '\t');
+			append_int(out, arrival_hop ? 1 : 0, '\t');
+			append_int(out, travelTime, '\t');
+			append_int(out, envelopeLabel, '\n');
+		}
+
+		static void append_int(std::string& out, int value, char separator)
+		{
+			char digits[12];
+			int length = 0;
+			unsigned int magnitude = value < 0 ? 0u - static_cast<unsigned int>(value) : static_cast<unsigned int>(value);
+			do
+			{
+				digits[length++] = static_cast<char>('0' + magnitude % 10);
+				magnitude /= 10;
+			} while (magnitude != 0);
+			if (value < 0)
+			{
+				out.push_back('-');
+			}
+			while (length > 0)
+			{
+				out.push_back(digits[--length]);
+			}
+			out.push_back(separator);
+		}
+
+		static std::vector<std::string> column_names()
+		{
+			return { "srcNode", "destNode", "hopSource", "hopDest", "msgLabel", "timestamp", "hopCount", "startTime", "endTime", "arrival_hop", "travelTime", "envelopeLabel" };
+		}
+
+		static void write_columns(ColumnarWriter& writer, std::vector<MessageHopLogEntry> const& entries)
+		{
+			//Same order as column_names(); a message's source, sink, start time and envelope are keyed on its label
+			const int label = 4;
+			writer.begin_chunk(entries.size());
+			writer.add_column([&](std::size_t row) { return entries[row].srcNode; }, label);
+			writer.add_column([&](std::size_t row) { return entries[row].destNode; }, label);
+			writer.add_column([&](std::size_t row) { return entries[row].hopSource; });
+			writer.add_column([&](std::size_t row) { return entries[row].hopDest; });
+			writer.add_column([&](std::size_t row) { return entries[row].msgLabel; });
+			writer.add_column([&](std::size_t row) { return entries[row].timestamp; });
+			writer.add_column([&](std::size_t row) { return entries[row].hopCount; });
+			writer.add_column([&](std::size_t row) { return entries[row].startTime; }, label);
+			writer.add_column([&](std::size_t row) { return entries[row].endTime; });
+			writer.add_column([&](std::size_t row) { return entries[row].arrival_hop ? 1 : 0; });
+			writer.add_column([&](std::size_t row) { return entries[row].travelTime; });
+			writer.add_column([&](std::size_t row) { return entries[row].envelopeLabel; }, label);
+			writer.end_chunk();
+		}
+
+		//Decodes the current chunk of reader; columns are found by name, missing ones are left at 0. False if a column is damaged
+		static bool read_columns(ColumnarReader const& reader, std::vector<MessageHopLogEntry>& entries, std::vector<int>& scratch)
+		{
+			entries.assign(reader.rows(), MessageHopLogEntry());
+			const std::vector<std::string> names = column_names();
+			for (std::size_t column = 0; column < names.size(); ++column)
+			{
+				const int index = reader.column_index(names[column]);
+				if (index < 0)
+				{
+					continue;
+				}
+				if (!reader.decode_column(index, scratch))
+				{
+					return false;
+				}
+				for (std::size_t row = 0; row < entries.size(); ++row)
+				{
+					MessageHopLogEntry& entry = entries[row];
+					const int value = scratch[row];
+					switch (column)
+					{
+					case 0: entry.srcNode = value; break;
+					case 1: entry.destNode = value; break;
+					case 2: entry.hopSource = value; break;
+					case 3: entry.hopDest = value; break;
+					case 4: entry.msgLabel = value; break;
+					case 5: entry.timestamp = value; break;
+					case 6: entry.hopCount = value; break;
+					case 7: entry.startTime = value; break;
+					case 8: entry.endTime = value; break;
+					case 9: entry.arrival_hop = value != 0; break;
+					case 10: entry.travelTime = value; break;
+					case 11: entry.envelopeLabel = value; break;
+					default: break;
+					}
+				}
+			}
+			return true;
 		}
 	};
 	/*
@@ -50,41 +207,220 @@ namespace DC{
 	*/
 
 
+	enum class LogFormat { tsv, columnar };
+
+	/*
+	 *	By default entries are kept in memory and written by print().
+	 *	After open(), entries are instead batched into fixed-size chunks that a background thread writes to the file
+	 *	as TSV or in the columnar binary layout of columnar_log.h while the simulation continues. Only max_chunks chunks of chunk_entries entries ever exist, so memory
+	 *	stays bounded; print() does nothing in that mode because the file is already being written.
+	 */
 	template<typename T>
 	class Logger
 	{
 	public:
+		Logger() = default;
+		~Logger() { close(); }
+		Logger(Logger const& other) : _entries(other._entries), _sample_rate(other._sample_rate), _enabled(other._enabled) {}
+		Logger& operator=(Logger const& other) { _entries = other._entries; _sample_rate = other._sample_rate; _enabled = other._enabled; return *this; }
 
 		void addEntry(T const& entry);
 		void print(std::ostream& os, bool arrival_only = false);
+
+		void open(std::string const& file_name, bool arrival_only = false, std::size_t chunk_entries = 4096, std::size_t max_chunks = 16,
+			LogFormat format = LogFormat::tsv);
+		void close();
+		bool streaming() const { return _stream != nullptr; }
+		//Chunk hand-offs of the last streamed run that had to wait for the writer to free a chunk
+		std::size_t stalls() const { return _stream ? _stream->stalls_ : _stalls; }
+
+		//Keep only messages whose label is a multiple of rate; whole journeys are kept or dropped together
+		void set_sample_rate(int rate) { _sample_rate = rate; }
+		bool samples(int msg_label) const { return _enabled && (_sample_rate <= 1 || msg_label % _sample_rate == 0); }
+		//A disabled logger records nothing, e.g. for runs that only need the RunStats
+		void set_enabled(bool enabled) { _enabled = enabled; }
 		
 	private:
 		friend std::ostream& operator<<(std::ostream& os, Logger const& entry);
+
+		struct Stream
+		{
+			using Chunk = std::vector<T>;
+
+			Stream(std::size_t chunk_entries, std::size_t max_chunks) :
+				chunks_(max_chunks), full_(max_chunks), free_(max_chunks), chunk_entries_(chunk_entries) {}
+
+			void add(T const& entry);
+			void hand_off();
+			void write_loop();
+
+			std::ofstream			file_;
+			std::vector<Chunk>		chunks_;
+			SpscRing<Chunk*>		full_;	//Simulation thread -> writer
+			SpscRing<Chunk*>		free_;	//Writer -> simulation thread
+			Chunk*					current_ = nullptr;
+			std::atomic<bool>		closing_{ false };
+			std::thread				writer_;
+			std::size_t				chunk_entries_;
+			bool					arrival_only_ = false;
+			LogFormat				format_ = LogFormat::tsv;
+			std::size_t				stalls_ = 0;	//Times the simulation had to wait for the writer to free a chunk
+		};
 		
 		std::vector<T> _entries;
-
+		std::unique_ptr<Stream> _stream;
+		std::size_t _stalls = 0;
+		int _sample_rate = LogPolicy::sample_rate;
+		bool _enabled = true;
 	};
 	
 	template<typename T>
 	inline void Logger<T>::addEntry(T const& entry)
 	{
+		if (_stream)
+		{
+			_stream->add(entry);
+			return;
+		}
 		_entries.push_back(entry);
 	}
 
+	template<typename T>
+	void Logger<T>::open(std::string const& file_name, bool arrival_only, std::size_t chunk_entries, std::size_t max_chunks, LogFormat format)
+	{
+		close();
+		assert(chunk_entries > 0 && max_chunks > 1);
+
+		_stream.reset(new Stream(chunk_entries, max_chunks));
+		_stream->arrival_only_ = arrival_only;
+		_stream->format_ = format;
+		_stream->file_.open(file_name, format == LogFormat::columnar ? std::ios::out | std::ios::binary : std::ios::out);
+		for (auto& chunk : _stream->chunks_)
+		{
+			chunk.reserve(chunk_entries);
+		}
+		_stream->current_ = &_stream->chunks_[0];
+		for (std::size_t ndx = 1; ndx < max_chunks; ++ndx)
+		{
+			_stream->free_.try_push(&_stream->chunks_[ndx]);
+		}
+
+		Stream* stream = _stream.get();
+		_stream->writer_ = std::thread([stream]() { stream->write_loop(); });
+	}
+
+	template<typename T>
+	void Logger<T>::close()
+	{
+		if (!_stream)
+		{
+			return;
+		}
+
+		if (!_stream->current_->empty())
+		{
+			_stream->full_.try_push(_stream->current_);
+		}
+		_stream->closing_.store(true, std::memory_order_release);
+		_stream->writer_.join();
+		_stalls = _stream->stalls_;
+		_stream.reset();
+	}
+
+	template<typename T>
+	inline void Logger<T>::Stream::add(T const& entry)
+	{
+		if (arrival_only_ && !entry.arrival_hop)
+		{
+			return;
+		}
+
+		current_->push_back(entry);
+		if (current_->size() == chunk_entries_)
+		{
+			hand_off();
+		}
+	}
+
+	template<typename T>
+	void Logger<T>::Stream::hand_off()
+	{
+		//There are as many ring slots as chunks, so the full ring always has room for ours
+		bool pushed = full_.try_push(current_);
+		assert(pushed);
+		(void)pushed;
+
+		if (!free_.try_pop(current_))
+		{
+			//Every chunk is still queued for the writer; memory stays bounded by blocking the simulation until one is free
+			++stalls_;
+			while (!free_.try_pop(current_))
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	template<typename T>
+	void Logger<T>::Stream::write_loop()
+	{
+		ColumnarWriter columnar{ file_ };
+		std::string text;
+		if (format_ == LogFormat::columnar)
+		{
+			columnar.write_header(T::column_names());
+		}
+		else
+		{
+			T::print_header(file_);
+		}
+
+		Chunk* chunk = nullptr;
+		while (true)
+		{
+			if (full_.try_pop(chunk))
+			{
+				if (format_ == LogFormat::columnar)
+				{
+					T::write_columns(columnar, *chunk);
+				}
+				else
+				{
+					text.clear();
+					for (auto& entry : *chunk)
+					{
+						entry.append_tsv(text);
+					}
+					file_.write(text.data(), static_cast<std::streamsize>(text.size()));
+				}
+				chunk->clear();
+				free_.try_push(chunk);
+			}
+			else if (closing_.load(std::memory_order_acquire))
+			{
+				//The last chunk was queued before closing_ was set, so an empty ring now means we are done
+				if (full_.empty())
+				{
+					break;
+				}
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			}
+		}
+		file_.flush();
+	}
+
 	template <typename T>
 	void Logger<T>::print(std::ostream& os, bool arrival_only)
 	{
-		os << "srcNode" << "\t";
-		os << "destNode" << "\t";
-		os << "hopSource" << "\t";
-		os << "hopDest" << "\t";
-		os << "msgLabel" << "\t";
-		os << "timestamp" << "\t";
-		os << "hopCount" << "\t";
-		os << "startTime" << "\t";
-		os << "endTime" << "\t";
-		os << "arrival_hop" << "\t";
-		os << "travelTime" << "\n";
+		if (_stream)
+		{
+			return; //The background writer owns the output
+		}
+
+		T::print_header(os);
 		for(auto& entry: _entries)
 		{
 			if(!arrival_only || entry.arrival_hop)
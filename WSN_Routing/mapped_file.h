@@ -0,0 +1,133 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace DC
+{
+	/*
+	 *	Read-only memory mapping of a whole file.
+	 *	is_open() is false if the file could not be opened or mapped; an empty file maps to size() == 0.
+	 */
+	class MappedFile
+	{
+	public:
+		inline explicit			MappedFile(std::string const& file_name);
+		inline					~MappedFile();
+								MappedFile(MappedFile const& other) = delete;
+		MappedFile&				operator=(MappedFile const& other) = delete;
+
+		bool					is_open() const							{ return open_; }
+		char const*				data() const							{ return data_; }
+		std::size_t				size() const							{ return size_; }
+
+	private:
+		char const*				data_ = nullptr;
+		std::size_t				size_ = 0;
+		bool					open_ = false;
+#ifdef _WIN32
+		HANDLE					file_ = INVALID_HANDLE_VALUE;
+		HANDLE					mapping_ = nullptr;
+#else
+		int						file_ = -1;
+#endif
+	};
+
+#ifdef _WIN32
+	inline MappedFile::MappedFile(std::string const& file_name)
+	{
+		file_ = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file_ == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file_, &size))
+		{
+			return;
+		}
+		size_ = static_cast<std::size_t>(size.QuadPart);
+		open_ = true;
+		if (size_ == 0)
+		{
+			return;
+		}
+
+		mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping_ != nullptr)
+		{
+			data_ = static_cast<char const*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+		}
+		open_ = data_ != nullptr;
+	}
+
+	inline MappedFile::~MappedFile()
+	{
+		if (data_ != nullptr)
+		{
+			UnmapViewOfFile(data_);
+		}
+		if (mapping_ != nullptr)
+		{
+			CloseHandle(mapping_);
+		}
+		if (file_ != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(file_);
+		}
+	}
+#else
+	inline MappedFile::MappedFile(std::string const& file_name)
+	{
+		file_ = ::open(file_name.c_str(), O_RDONLY);
+		if (file_ < 0)
+		{
+			return;
+		}
+
+		struct stat info;
+		if (fstat(file_, &info) != 0)
+		{
+			return;
+		}
+		size_ = static_cast<std::size_t>(info.st_size);
+		open_ = true;
+		if (size_ == 0)
+		{
+			return;
+		}
+
+		void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_, 0);
+		if (mapped != MAP_FAILED)
+		{
+			data_ = static_cast<char const*>(mapped);
+			madvise(mapped, size_, MADV_SEQUENTIAL);
+		}
+		open_ = data_ != nullptr;
+	}
+
+	inline MappedFile::~MappedFile()
+	{
+		if (data_ != nullptr)
+		{
+			munmap(const_cast<char*>(data_), size_);
+		}
+		if (file_ >= 0)
+		{
+			::close(file_);
+		}
+	}
+#endif
+}
@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include "profiler.h"
 
 namespace DC
 {
@@ -11,7 +12,7 @@ namespace DC
 	{
 	    using string            = std::string;
 	 public:
-	    enum class MessageType{ msg, ack, heartbeat, protocol };
+	    enum class MessageType{ msg, ack, heartbeat, protocol, aggregate };
 	 
 	    inline                  Message(Node* source, Node* destination, string& contents, int start_time, MessageType message_type = MessageType::msg);
 
@@ -22,6 +23,7 @@ namespace DC
 	    Node*                   hop_destination() const             { return hop_destination_; }
 	    void                    set_hop_source(Node* new_source)    { hop_source_ = new_source; }
 	    void                    set_hop_destination(Node* new_dst)  { hop_destination_ = new_dst; }
+	    void                    set_destination(Node* new_dst)      { destination_ = new_dst; }
 	    string                  contents() const                    { return contents_;}
 
 	    void                    set_arrival_time(int arrival_time)  { arrival_time_ = arrival_time; }
@@ -38,6 +40,11 @@ namespace DC
 
 		int						label() const						{ return label_; }
 		int						envelope_label() const				{ return envelope_label_; }
+
+		//An aggregate carries other messages (fused readings) instead of being one; the carried messages take its label
+		//as their envelope label, hop along with it and are read individually at the destination
+		void					carry(std::shared_ptr<Message> const& msg)	{ msg->envelope_label_ = label_; carried_.push_back(msg); }
+		std::vector<std::shared_ptr<Message>> const& carried() const	{ return carried_; }
 		int						start_time() const					{ return start_time_; }
 
 		void					set_hop_timestamp(int hop_timestamp) { hop_timestamp_ = hop_timestamp; }
@@ -60,12 +67,13 @@ namespace DC
 	    int                     start_time_     = 0;
 	    int                     arrival_time_   = 0;
 		int						hop_timestamp_	= 0;
-		static int				ID_COUNTER;
+		static thread_local int	ID_COUNTER; //Per thread, so simulations can run side by side
 		int						label_			= 0;
 		int						envelope_label_ = 0;
 	 
 		bool					priority_		= false;
 	    std::shared_ptr<void>   ext_data_;
+		std::vector<std::shared_ptr<Message>> carried_;
 
 	    //Messages should have an ID, too, in case of duplicate messages
 	    //Can use the sender's ID and initial timestamp for that (in an actual system)
@@ -74,11 +82,12 @@ namespace DC
 
 	using MessagePtr = std::shared_ptr<Message>;
 
-	int Message::ID_COUNTER = 0;
+	thread_local int Message::ID_COUNTER = 0;
 
 	inline Message::Message(Node* _source, Node* _destination, string& _contents, int start_time, MessageType _message_type) :
 	    message_type_{ _message_type }, source_{ _source }, destination_{ _destination }, contents_{ _contents }, start_time_{ start_time }
 	{
+		WSN_PROFILE_COUNT(message_allocations);
 		id_ = (int)(this);
 		label_ = ID_COUNTER++;
 		envelope_label_ = label_;
@@ -3,30 +3,112 @@
 #include <deque>
 namespace DC
 {
+	/*
+	 *	What a full queue does with one more message:
+	 *		tail_drop			the incoming message is dropped
+	 *		drop_oldest			the message at the front is dropped to make room
+	 *		drop_non_priority	the newest queued non-priority message is dropped to make room for a priority one;
+	 *							a non-priority message (or a priority one when nothing can be evicted) is dropped
+	 */
+	enum class DropPolicy { tail_drop, drop_oldest, drop_non_priority };
+
+	//Queue capacities applied by Environment::bound_queues; 0 leaves a queue unbounded
+	struct QueueLimits
+	{
+		std::size_t inbox_ = 0;
+		std::size_t outbox_ = 0;
+		std::size_t algorithm_ = 0;
+		DropPolicy policy_ = DropPolicy::tail_drop;
+	};
+
 	class MessageQueue
 	{
 	public:
 		MessageQueue();
-		void push(MessagePtr msg);
-		void priority_push(MessagePtr msg);
+		//push and priority_push return the message that was dropped, if the queue was full
+		MessagePtr push(MessagePtr msg);
+		MessagePtr priority_push(MessagePtr msg);
 		MessagePtr pop(int curr_time);
 		bool empty(int curr_time);
 		bool contains(MessagePtr msg);
 		bool remove(MessagePtr msg);
+		std::size_t size() const { return msgs.size(); }
+
+		//A capacity of 0 means unbounded. The queue reports backpressure once it is filled to the high-water mark.
+		void set_capacity(std::size_t capacity, DropPolicy policy = DropPolicy::tail_drop);
+		std::size_t capacity() const { return capacity_; }
+		bool backpressure() const { return capacity_ != 0 && msgs.size() >= high_water_; }
+		std::size_t drops() const { return drops_; }
 	private:
+		MessagePtr make_room(MessagePtr const& incoming);
+
 		std::deque<MessagePtr> msgs;
+		std::size_t capacity_ = 0;
+		std::size_t high_water_ = 0;
+		DropPolicy policy_ = DropPolicy::tail_drop;
+		std::size_t drops_ = 0;
 	};
 
 	MessageQueue::MessageQueue() {
 	}
 
-	void MessageQueue::push(MessagePtr msg) {
+	void MessageQueue::set_capacity(std::size_t capacity, DropPolicy policy) {
+		capacity_ = capacity;
+		high_water_ = capacity - capacity / 4;
+		policy_ = policy;
+	}
+
+	MessagePtr MessageQueue::make_room(MessagePtr const& incoming) {
+		//Returns the message to drop; if that is the incoming one, the caller must not queue it
+		++drops_;
+		if (policy_ == DropPolicy::drop_oldest)
+		{
+			MessagePtr dropped = msgs.front();
+			msgs.pop_front();
+			return dropped;
+		}
+		if (policy_ == DropPolicy::drop_non_priority && incoming->priority())
+		{
+			for (auto it = msgs.end(); it != msgs.begin();)
+			{
+				--it;
+				if (!(*it)->priority())
+				{
+					MessagePtr dropped = *it;
+					msgs.erase(it);
+					return dropped;
+				}
+			}
+		}
+		return incoming;
+	}
+
+	MessagePtr MessageQueue::push(MessagePtr msg) {
+		MessagePtr dropped;
+		if (capacity_ != 0 && msgs.size() >= capacity_)
+		{
+			dropped = make_room(msg);
+			if (dropped == msg)
+			{
+				return dropped;
+			}
+		}
 		msgs.push_back(msg);
+		return dropped;
 	}
 
-	void MessageQueue::priority_push(MessagePtr msg) {
+	MessagePtr MessageQueue::priority_push(MessagePtr msg) {
 		//msg->set_priority(true); //If this message doesn't already have priority, it better have priority now
 		assert(msg->priority());
+		MessagePtr dropped;
+		if (capacity_ != 0 && msgs.size() >= capacity_)
+		{
+			dropped = make_room(msg);
+			if (dropped == msg)
+			{
+				return dropped;
+			}
+		}
 		auto it = msgs.cbegin();
 		while (it != msgs.cend() && (*it)->priority())
 		{
@@ -43,6 +125,7 @@ namespace DC
 			//They are all priority messages, so put it at the end
 			msgs.push_back(msg);
 		}
+		return dropped;
 	}
 
 	MessagePtr MessageQueue::pop(int curr_time) {
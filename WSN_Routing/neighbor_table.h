@@ -0,0 +1,179 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <iterator>
+
+namespace DC
+{
+	class Node;
+
+	//The neighbors of one node as Node pointers, viewed straight out of a NeighborTable row
+	class NeighborRange
+	{
+	public:
+		class iterator
+		{
+		public:
+			using iterator_category	= std::forward_iterator_tag;
+			using value_type		= Node*;
+			using difference_type	= std::ptrdiff_t;
+			using pointer			= Node* const*;
+			using reference			= Node*;
+
+									iterator(Node* const* nodes, std::uint32_t const* at) : nodes_(nodes), at_(at) {}
+			Node*					operator*() const						{ return nodes_[*at_]; }
+			iterator&				operator++()							{ ++at_; return *this; }
+			iterator				operator++(int)							{ iterator old = *this; ++at_; return old; }
+			bool					operator==(iterator const& other) const	{ return at_ == other.at_; }
+			bool					operator!=(iterator const& other) const	{ return at_ != other.at_; }
+
+		private:
+			Node* const*			nodes_;
+			std::uint32_t const*	at_;
+		};
+
+								NeighborRange(Node* const* nodes, std::uint32_t const* begin, std::uint32_t const* end) : nodes_(nodes), begin_(begin), end_(end) {}
+
+		iterator				begin() const								{ return iterator(nodes_, begin_); }
+		iterator				end() const									{ return iterator(nodes_, end_); }
+		std::size_t				size() const								{ return static_cast<std::size_t>(end_ - begin_); }
+		bool					empty() const								{ return begin_ == end_; }
+		Node*					operator[](std::size_t ndx) const			{ return nodes_[begin_[ndx]]; }
+		std::vector<Node*>		to_vector() const							{ return std::vector<Node*>(begin(), end()); }
+
+	private:
+		Node* const*			nodes_;
+		std::uint32_t const*	begin_;
+		std::uint32_t const*	end_;
+	};
+
+	/*
+	 *	The neighbor lists of every node of an Environment, as compressed sparse rows of node indices
+	 *	(node index i is the node labelled i + 1) plus a small open-addressing hash per row, so membership is O(1)
+	 *	instead of a scan of the row. Rows are laid out with room to spare; a row that outgrows it is moved to the end
+	 *	of the table with twice the room, so neighbors learned during a run are appended in amortised O(1).
+	 *	The abandoned space is not reclaimed, which is fine as long as learned neighbors are rare next to the
+	 *	physical ones reserved up front.
+	 */
+	class NeighborTable
+	{
+	public:
+		using Index				= std::uint32_t;
+
+		//nodes[i] is node index i; reserve_offsets is a CSR offsets array (size nodes.size() + 1) giving the number of
+		//neighbors to reserve room for per node, e.g. Topology::offsets()
+		inline void				reset(std::vector<Node*> nodes, std::vector<Index> const& reserve_offsets);
+
+		inline bool				contains(Index node, Index neighbor) const;
+		//Returns false if neighbor already was one
+		inline bool				add(Index node, Index neighbor);
+
+		NeighborRange			row(Index node) const
+		{
+			Index const* begin = slots_.data() + rows_[node].offset_;
+			return NeighborRange(nodes_.data(), begin, begin + rows_[node].size_);
+		}
+
+	private:
+		static constexpr Index	EMPTY = 0;	//Hash entries hold neighbor + 1
+		static constexpr Index	MIN_CAPACITY = 4;
+
+		struct row_info
+		{
+			Index				offset_ = 0;
+			Index				size_ = 0;
+			Index				capacity_ = 0;	//A power of two; the hash has 2 * capacity_ entries
+			Index				hash_offset_ = 0;
+		};
+
+		static Index			hash(Index neighbor)						{ neighbor *= 0x9E3779B1u; return neighbor ^ (neighbor >> 16); }
+		inline void				allocate(row_info& row, Index capacity);
+		inline void				insert_hash(row_info const& row, Index neighbor);
+
+		std::vector<Node*>		nodes_;
+		std::vector<row_info>	rows_;
+		std::vector<Index>		slots_;
+		std::vector<Index>		hash_;
+	};
+
+	inline void NeighborTable::reset(std::vector<Node*> nodes, std::vector<Index> const& reserve_offsets)
+	{
+		assert(reserve_offsets.size() == nodes.size() + 1);
+		nodes_ = std::move(nodes);
+		rows_.assign(nodes_.size(), row_info());
+		slots_.clear();
+		hash_.clear();
+		for (std::size_t node = 0; node < nodes_.size(); ++node)
+		{
+			Index capacity = MIN_CAPACITY;
+			while (capacity < reserve_offsets[node + 1] - reserve_offsets[node])
+			{
+				capacity *= 2;
+			}
+			allocate(rows_[node], capacity);
+		}
+	}
+
+	inline bool NeighborTable::contains(Index node, Index neighbor) const
+	{
+		row_info const& row = rows_[node];
+		const Index mask = 2 * row.capacity_ - 1;
+		Index const* table = hash_.data() + row.hash_offset_;
+		for (Index slot = hash(neighbor) & mask; table[slot] != EMPTY; slot = (slot + 1) & mask)
+		{
+			if (table[slot] == neighbor + 1)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline bool NeighborTable::add(Index node, Index neighbor)
+	{
+		assert(neighbor < nodes_.size());
+		if (contains(node, neighbor))
+		{
+			return false;
+		}
+
+		row_info& row = rows_[node];
+		if (row.size_ == row.capacity_)
+		{
+			//Move the row to the end with twice the room and rebuild its hash there
+			const Index old_offset = row.offset_;
+			allocate(row, row.capacity_ * 2);
+			for (Index ndx = 0; ndx < row.size_; ++ndx)
+			{
+				slots_[row.offset_ + ndx] = slots_[old_offset + ndx];
+				insert_hash(row, slots_[row.offset_ + ndx]);
+			}
+		}
+		slots_[row.offset_ + row.size_++] = neighbor;
+		insert_hash(row, neighbor);
+		return true;
+	}
+
+	inline void NeighborTable::allocate(row_info& row, Index capacity)
+	{
+		row.offset_ = static_cast<Index>(slots_.size());
+		row.capacity_ = capacity;
+		row.hash_offset_ = static_cast<Index>(hash_.size());
+		slots_.resize(slots_.size() + capacity);
+		hash_.resize(hash_.size() + 2 * capacity, Index(EMPTY));
+	}
+
+	inline void NeighborTable::insert_hash(row_info const& row, Index neighbor)
+	{
+		const Index mask = 2 * row.capacity_ - 1;
+		Index* table = hash_.data() + row.hash_offset_;
+		Index slot = hash(neighbor) & mask;
+		while (table[slot] != EMPTY)
+		{
+			slot = (slot + 1) & mask;
+		}
+		table[slot] = neighbor + 1;
+	}
+}
@@ -4,6 +4,11 @@
 #include "message_queue.hpp"
 #include <queue>
 #include "algorithm_base.h"
+#include "run_stats.h"
+#include "profiler.h"
+#include "sim_random.h"
+#include "neighbor_table.h"
+#include "destination_policy.h"
 
 /*
  *  NOTE: Add environment neighbor list
@@ -61,9 +66,16 @@ namespace DC
         inline void                 receive_message(MessagePtr msg);
 		inline void                 add_destination(Node& destination);
         inline void                 add_neighbor(Node& neighbor);
+        inline bool                 has_neighbor(Node const& other) const;
         inline void                 send_message(MessagePtr msg);
         inline void                 broadcast(MessagePtr msg);
         inline void                 tick(bool trigger_sensor);
+        inline void                 skip_ticks(int tick_count);
+        inline bool                 queues_empty() const                                            { return inbox_.size() == 0 && outbox_.size() == 0; }
+        inline std::size_t          inbox_depth() const                                             { return inbox_.size(); }
+        inline std::size_t          outbox_depth() const                                            { return outbox_.size(); }
+        inline bool                 backpressure() const                                            { return inbox_.backpressure() || outbox_.backpressure(); }
+        inline void                 count_drop(MessagePtr const& dropped);
         inline int                  distance_to(Node& other) const;
         inline int                  label() const                                                   { return label_; }
         inline bool                 has_sensor() const                                              { return has_sensor_; }
@@ -74,8 +86,8 @@ namespace DC
         //Algorithm-required functions
         inline bool                 inbox_pending()                                                 { return !inbox_.empty(now()); }
         inline MessagePtr           pop_inbox()                                                     { return inbox_.pop(now()); }
-        inline void                 push_outbox(MessagePtr new_message)                             { outbox_.push(new_message); }
-        inline std::vector<Node*>&  neighbors()                                                     { return neighbors_; }
+        inline void                 push_outbox(MessagePtr new_message)                             { if (MessagePtr dropped = outbox_.push(new_message)) { count_drop(dropped); } }
+        inline NeighborRange        neighbors() const                                               { return neighbor_table_->row(index()); }
         inline std::vector<Node*>&  destinations()                                                  { return destinations_; }
         inline void                 set_ext_data(void* ptr)                                         { ext_data_ = std::shared_ptr<void>(ptr); }
         inline double               battery_remaining_mA() const                                    { return battery_remaining_mA_; }
@@ -88,7 +100,6 @@ namespace DC
     protected:
         friend class        Environment;
 
-        std::vector<Node*>  neighbors_;
         std::vector<Node*>  phys_neighbors_;
         std::vector<Node*>  destinations_;
         MessageQueue        inbox_;
@@ -112,13 +123,21 @@ namespace DC
 
         Node* choose_destination() const;
         MessagePtr package_sensor_data(std::string);
+        inline void log_hop(MessagePtr const& msg);
 
         int sent_msg_count = 0;
         int recv_msg_count = 0;
         int inbox_msg_count = 0;
         int generated_msg_count_ = 0;
+        int dropped_msg_count_ = 0;
 
         AlgorithmBase* algo_;
+        RunStats* stats_ = nullptr;
+        SimRandom* random_ = nullptr;
+        NeighborTable* neighbor_table_ = nullptr; //Owned by the Environment, which labels node index i as i + 1
+        DestinationSelector* destination_selector_ = nullptr; //Owned by the Environment
+
+        NeighborTable::Index index() const                                                          { return static_cast<NeighborTable::Index>(label_ - 1); }
     };
 
     inline Node::Node(int label, int x, int y, bool has_sensor, bool active, AlgorithmBase& algo, double battery, int sensor_period) :
@@ -136,7 +155,41 @@ namespace DC
         battery_remaining_mA_ -= MSG_RECV_COST;
         battery_used_mA_ += MSG_RECV_COST;
         inbox_msg_count++;
-	    inbox_.push(msg);
+        if (stats_) { stats_->on_received(); }
+        if (destination_selector_ && destination_selector_->anycast() && msg->destination() != nullptr && msg->destination() != this &&
+            msg->arrival_time() == 0 && destination_selector_->is_sink(index()))
+        {
+            //Any sink will do; readings (or aggregates of them) that have not arrived yet stop here, whatever the algorithm.
+            //Broadcasts such as heartbeats have no destination and are left alone
+            msg->set_destination(this);
+        }
+        if (MessagePtr dropped = inbox_.push(msg))
+        {
+            count_drop(dropped); //The radio received it, but there was no room to keep it
+        }
+    }
+
+    inline void Node::count_drop(MessagePtr const& dropped)
+    {
+        //Also used by algorithms for messages they drop from their own bounded queues. Drops are counted in readings,
+        //like creations and deliveries, so a dropped aggregate counts every reading it carries
+        const int readings = dropped->message_type() == Message::MessageType::aggregate ? static_cast<int>(dropped->carried().size()) : 1;
+        dropped_msg_count_ += readings;
+        if (stats_) { stats_->on_dropped(readings); }
+        if (destination_selector_)
+        {
+            if (dropped->message_type() == Message::MessageType::aggregate)
+            {
+                for (MessagePtr const& reading : dropped->carried())
+                {
+                    if (reading->destination()) { destination_selector_->on_dropped(reading->destination()->index(), reading->label()); }
+                }
+            }
+            else if (dropped->destination())
+            {
+                destination_selector_->on_dropped(dropped->destination()->index(), dropped->label());
+            }
+        }
     }
 
     inline void Node::add_destination(Node& destination)
@@ -146,53 +199,99 @@ namespace DC
 
     inline void Node::add_neighbor(Node& neighbor)
     {
-        //Prevent duplicate neighbors
-        //TODO: Consider replacing this with a set or something that prevents duplicates
-        for (Node* n : neighbors_) {
-            if (&neighbor == n) { return; }
+        //Duplicates are rejected by the table's hash, so this is cheap enough to call on every received message
+        if (neighbor_table_->add(index(), neighbor.index()))
+        {
+            algo_->on_neighbor_added(this, &neighbor);
         }
-        neighbors_.push_back(&neighbor);
-        algo_->on_neighbor_added(this, &neighbor);
+    }
+
+    inline bool Node::has_neighbor(Node const& other) const
+    {
+        return neighbor_table_->contains(index(), other.index());
     }
 
     inline void Node::send_message(MessagePtr msg)
     {
+        WSN_PROFILE_SCOPE(delivery);
+        WSN_PROFILE_COUNT(hops_sent);
         Node* recipient = msg->hop_destination();
         msg->set_hop_source(id_);
         msg->increment_hop();
         msg->set_hop_timestamp(now());
         recipient->receive_message(msg);
         sent_msg_count++;
+        if (stats_) { stats_->on_sent(); }
         battery_remaining_mA_ -= MSG_SEND_COST;
         battery_used_mA_ += MSG_SEND_COST;
-        int dest_label = msg->destination() ? msg->destination()->label() : -1;
-        MessageHopLogEntry entry{ msg->source()->label(), dest_label, msg->hop_source()->label(), msg->hop_destination()->label(),
-            msg->label(), now(), msg->hop_count(), msg->start_time(), msg->arrival_time(), msg->travel_time() };
-        (*algo_).logger_.addEntry(entry);
+        if (msg->message_type() != Message::MessageType::aggregate)
+        {
+            log_hop(msg);
+            return;
+        }
+
+        //The carried messages make the hop too; the log records them, tagged with the aggregate as their envelope
+        for (MessagePtr const& carried : msg->carried())
+        {
+            carried->set_hop_source(id_);
+            carried->set_hop_destination(recipient);
+            carried->increment_hop();
+            carried->set_hop_timestamp(now());
+            log_hop(carried);
+        }
+    }
+
+    inline void Node::log_hop(MessagePtr const& msg)
+    {
+        if (LogPolicy::hops && (*algo_).logger_.samples(msg->label()))
+        {
+            WSN_PROFILE_SCOPE(logging);
+            WSN_PROFILE_COUNT(log_entries);
+            int dest_label = msg->destination() ? msg->destination()->label() : -1;
+            MessageHopLogEntry entry{ msg->source()->label(), dest_label, msg->hop_source()->label(), msg->hop_destination()->label(),
+                msg->label(), now(), msg->hop_count(), msg->start_time(), msg->arrival_time(), msg->travel_time() };
+            entry.envelopeLabel = msg->envelope_label();
+            (*algo_).logger_.addEntry(entry);
+        }
     }
 
     inline void Node::broadcast(MessagePtr msg)
     {
+        WSN_PROFILE_SCOPE(delivery);
+        WSN_PROFILE_COUNT(hops_sent);
         msg->set_hop_source(id_);
         msg->increment_hop();
         msg->set_hop_timestamp(now());
-        for (Node* neighbor : neighbors_) {
+        for (Node* neighbor : neighbors()) {
             MessagePtr new_msg{ new Message(*msg) };
+            WSN_PROFILE_COUNT(broadcast_copies);
+            WSN_PROFILE_COUNT(message_allocations);
 			new_msg->set_hop_destination(neighbor);
             neighbor->receive_message(new_msg);
         }
         sent_msg_count++;
+        if (stats_) { stats_->on_sent(); }
         battery_remaining_mA_ -= MSG_SEND_COST;
         battery_used_mA_ += MSG_RECV_COST;
-        int dest_label = msg->destination() ? msg->destination()->label() : -1;
-        MessageHopLogEntry entry{ msg->source()->label(), dest_label, msg->hop_source()->label(), -1,
-            msg->label(), now(), msg->hop_count(), msg->start_time(), msg->arrival_time(), msg->travel_time() };
-        (*algo_).logger_.addEntry(entry);
+        if (LogPolicy::hops && (*algo_).logger_.samples(msg->label()))
+        {
+            WSN_PROFILE_SCOPE(logging);
+            WSN_PROFILE_COUNT(log_entries);
+            int dest_label = msg->destination() ? msg->destination()->label() : -1;
+            MessageHopLogEntry entry{ msg->source()->label(), dest_label, msg->hop_source()->label(), -1,
+                msg->label(), now(), msg->hop_count(), msg->start_time(), msg->arrival_time(), msg->travel_time() };
+            entry.envelopeLabel = msg->envelope_label();
+            (*algo_).logger_.addEntry(entry);
+        }
     }
 
     inline Node* Node::choose_destination() const
     {
-        int val = std::rand();
+        if (destination_selector_ && destination_selector_->policy() != DestinationPolicy::random)
+        {
+            return destination_selector_->choose(index());
+        }
+        int val = random_ ? random_->next() : std::rand();
         // std::cout << val << "\t";
         val %= destinations_.size();
         return destinations_[val];
@@ -200,10 +299,13 @@ namespace DC
 
     inline MessagePtr Node::package_sensor_data(std::string data)
     {
+        WSN_PROFILE_SCOPE(sensing);
+        WSN_PROFILE_COUNT(messages_created);
         Node* destination = choose_destination();
         MessagePtr msg{ new Message(this, destination, data, num_ticks_) };
         algo_->on_message_init(msg);
         generated_msg_count_++;
+        if (stats_) { stats_->on_created(); }
         return msg;
     }
 
@@ -215,6 +317,7 @@ namespace DC
             return; //The node is either asleep or dead; it can't do anything
         }
 
+        WSN_PROFILE_COUNT(node_ticks);
         num_ticks_++;
         battery_remaining_mA_ -= AWAKE_COST; //This is the cost of listening for messages
         battery_used_mA_ += AWAKE_COST;
@@ -224,7 +327,10 @@ namespace DC
             sensor_data = package_sensor_data("This is data! Very Important");
         }
 
-        (* algo_)(this, sensor_data);
+        {
+            WSN_PROFILE_SCOPE(algorithm);
+            (* algo_)(this, sensor_data);
+        }
 
         /*
         if (battery_remaining_mA_ <= 0)
@@ -247,6 +353,21 @@ namespace DC
             }
         }
     }
+
+    inline void Node::skip_ticks(int tick_count)
+    {
+        //Equivalent to tick_count calls to tick(false) while the node has nothing to do
+        if (!active_)
+        {
+            return;
+        }
+        assert(queues_empty());
+
+        num_ticks_ += tick_count;
+        battery_remaining_mA_ -= AWAKE_COST * tick_count;
+        battery_used_mA_ += AWAKE_COST * tick_count;
+    }
+
     inline int Node::distance_to(Node& other) const
     {
         int x_dist = ed.location_.x_ - other.ed.location_.x_;
@@ -272,14 +393,40 @@ namespace DC
 
     inline void Node::read_msg(MessagePtr msg)
     {
+        if (msg->message_type() == Message::MessageType::aggregate)
+        {
+            //Only the readings an aggregate carries count as delivered
+            for (MessagePtr const& carried : msg->carried())
+            {
+                read_msg(carried);
+            }
+            return;
+        }
+
+        if (destination_selector_ && !destination_selector_->on_delivered(index(), msg->label()))
+        {
+            return;
+        }
         recv_msg_count++;
         archive_.push(msg);
         msg->set_arrival_time(now());
-        int dest_label = msg->destination() ? msg->destination()->label() : -1;
-        MessageHopLogEntry entry{ msg->source()->label(), dest_label, msg->hop_source()->label(), -1,
-            msg->label(), now(), msg->hop_count(), msg->start_time(), msg->arrival_time(), msg->travel_time(), true };
-        (*algo_).logger_.addEntry(entry);
+        if (stats_) { stats_->on_delivered(msg->hop_count(), msg->travel_time()); }
+        if (LogPolicy::arrivals && (*algo_).logger_.samples(msg->label()))
+        {
+            WSN_PROFILE_SCOPE(logging);
+            WSN_PROFILE_COUNT(log_entries);
+            int dest_label = msg->destination() ? msg->destination()->label() : -1;
+            MessageHopLogEntry entry{ msg->source()->label(), dest_label, msg->hop_source()->label(), -1,
+                msg->label(), now(), msg->hop_count(), msg->start_time(), msg->arrival_time(), msg->travel_time(), true };
+            entry.envelopeLabel = msg->envelope_label();
+            (*algo_).logger_.addEntry(entry);
+        }
         //std::cout << "Node " << label_ << " Received this message: " << msg->contents() << std::endl; //Read the contents
         //std::cout << "Hop Count was " << msg->hop_count() << std::endl;
     }
+
+    inline std::uint32_t AlgorithmBase::index_of(Node const* node)
+    {
+        return static_cast<std::uint32_t>(node->label() - 1);
+    }
 }
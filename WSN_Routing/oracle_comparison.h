@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <ostream>
+#include "run_stats.h"
+
+namespace DC
+{
+	/*
+	 *	Puts a run next to the AlgorithmOracle run of the same configuration: hop count and latency as ratios to the
+	 *	oracle's, so 1 is shortest-path routing and anything above it is what the algorithm leaves on the table.
+	 */
+	class OracleComparison
+	{
+	public:
+		static inline void		write_header(std::ostream& os);
+		static inline void		write(std::ostream& os, std::string const& name, int sensor_period, int high_load,
+									RunSummary const& summary, RunSummary const& oracle);
+
+	private:
+		static double			ratio(double value, double oracle)					{ return oracle > 0 ? value / oracle : 0.0; }
+	};
+
+	inline void OracleComparison::write_header(std::ostream& os)
+	{
+		os << "algorithm" << "\t";
+		os << "sensor_period" << "\t";
+		os << "high_load" << "\t";
+		os << "delivery_ratio" << "\t";
+		os << "avg_hops" << "\t";
+		os << "avg_latency" << "\t";
+		os << "hop_ratio" << "\t";
+		os << "latency_ratio" << "\n";
+	}
+
+	inline void OracleComparison::write(std::ostream& os, std::string const& name, int sensor_period, int high_load,
+		RunSummary const& summary, RunSummary const& oracle)
+	{
+		os << name << "\t";
+		os << sensor_period << "\t";
+		os << high_load << "\t";
+		os << summary.delivery_ratio_ << "\t";
+		os << summary.avg_hops_ << "\t";
+		os << summary.avg_latency_ << "\t";
+		os << ratio(summary.avg_hops_, oracle.avg_hops_) << "\t";
+		os << ratio(summary.avg_latency_, oracle.avg_latency_) << "\n";
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/*
+ *	Simulator hot-path profiling, compiled in only with WSN_PROFILE=1 (e.g. /D WSN_PROFILE=1).
+ *	WSN_PROFILE_SCOPE(phase) times the rest of the enclosing block; nested scopes are subtracted from their parent,
+ *	so every phase reports exclusive time and the phases add up to the run total. WSN_PROFILE_COUNT bumps a counter.
+ *	With profiling off both macros expand to nothing.
+ */
+#ifndef WSN_PROFILE
+#define WSN_PROFILE 0
+#endif
+
+namespace DC
+{
+	enum class ProfilePhase { environment, on_tick, algorithm, sensing, delivery, logging, count };
+	enum class ProfileCounter { ticks, node_ticks, messages_created, hops_sent, broadcast_copies, message_allocations, log_entries, count };
+
+	class Profiler
+	{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		class Scope
+		{
+		public:
+			inline explicit			Scope(ProfilePhase phase);
+			inline					~Scope();
+									Scope(Scope const& other) = delete;
+			Scope&					operator=(Scope const& other) = delete;
+
+		private:
+			friend class			Profiler;
+			ProfilePhase			phase_;
+			clock::time_point		start_;
+			std::int64_t			child_ns_ = 0;
+			Scope*					parent_;
+		};
+
+		//One profiler per simulation thread; the Environment resets it at the start of a run
+		static Profiler&			current()								{ static thread_local Profiler profiler; return profiler; }
+
+		inline void					reset();
+		void						count(ProfileCounter counter)			{ ++counters_[static_cast<int>(counter)]; }
+		inline void					write_json(std::ostream& os) const;
+
+	private:
+		std::int64_t				phase_ns_[static_cast<int>(ProfilePhase::count)] = {};
+		std::int64_t				phase_calls_[static_cast<int>(ProfilePhase::count)] = {};
+		std::int64_t				counters_[static_cast<int>(ProfileCounter::count)] = {};
+		Scope*						active_ = nullptr;
+	};
+
+	inline Profiler::Scope::Scope(ProfilePhase phase) : phase_(phase), start_(clock::now())
+	{
+		Profiler& profiler = current();
+		parent_ = profiler.active_;
+		profiler.active_ = this;
+	}
+
+	inline Profiler::Scope::~Scope()
+	{
+		const std::int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_).count();
+		Profiler& profiler = current();
+		profiler.phase_ns_[static_cast<int>(phase_)] += elapsed - child_ns_;
+		++profiler.phase_calls_[static_cast<int>(phase_)];
+		if (parent_)
+		{
+			parent_->child_ns_ += elapsed;
+		}
+		profiler.active_ = parent_;
+	}
+
+	inline void Profiler::reset()
+	{
+		for (auto& ns : phase_ns_) { ns = 0; }
+		for (auto& calls : phase_calls_) { calls = 0; }
+		for (auto& counter : counters_) { counter = 0; }
+	}
+
+	inline void Profiler::write_json(std::ostream& os) const
+	{
+		static char const* const phase_names[] = { "environment", "on_tick", "algorithm", "sensing", "delivery", "logging" };
+		static char const* const counter_names[] = { "ticks", "node_ticks", "messages_created", "hops_sent", "broadcast_copies", "message_allocations", "log_entries" };
+
+		std::int64_t total_ns = 0;
+		for (auto ns : phase_ns_)
+		{
+			total_ns += ns;
+		}
+
+		os << "{\n  \"total_ns\": " << total_ns << ",\n  \"phases\": {\n";
+		for (int phase = 0; phase < static_cast<int>(ProfilePhase::count); ++phase)
+		{
+			os << "    \"" << phase_names[phase] << "\": { \"ns\": " << phase_ns_[phase] << ", \"calls\": " << phase_calls_[phase] << " }";
+			os << (phase + 1 < static_cast<int>(ProfilePhase::count) ? ",\n" : "\n");
+		}
+		os << "  },\n  \"counters\": {\n";
+		for (int counter = 0; counter < static_cast<int>(ProfileCounter::count); ++counter)
+		{
+			os << "    \"" << counter_names[counter] << "\": " << counters_[counter];
+			os << (counter + 1 < static_cast<int>(ProfileCounter::count) ? ",\n" : "\n");
+		}
+		os << "  }\n}\n";
+	}
+}
+
+#if WSN_PROFILE
+#define WSN_PROFILE_CONCAT_(a, b) a##b
+#define WSN_PROFILE_CONCAT(a, b) WSN_PROFILE_CONCAT_(a, b)
+#define WSN_PROFILE_SCOPE(phase) ::DC::Profiler::Scope WSN_PROFILE_CONCAT(profile_scope_, __LINE__){ ::DC::ProfilePhase::phase }
+#define WSN_PROFILE_COUNT(counter) ::DC::Profiler::current().count(::DC::ProfileCounter::counter)
+#else
+#define WSN_PROFILE_SCOPE(phase)
+#define WSN_PROFILE_COUNT(counter)
+#endif
@@ -0,0 +1,211 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+
+namespace DC
+{
+	//Queue depths of one node at one sample, saturated at 65535
+	struct QueueSample
+	{
+		std::uint16_t			inbox_ = 0;
+		std::uint16_t			outbox_ = 0;
+		std::uint16_t			algorithm_ = 0;
+
+		int						total() const							{ return inbox_ + outbox_ + algorithm_; }
+		static std::uint16_t	clamp(std::size_t depth)				{ return static_cast<std::uint16_t>(std::min<std::size_t>(depth, 0xFFFF)); }
+	};
+
+	/*
+	 *	Samples the inbox, outbox and algorithm queue depth of every node every sample_period ticks.
+	 *	Frames (one sample per node) go into a fixed ring of capacity frames, so a long run keeps the most recent
+	 *	ones; the per-node totals behind write_nodes cover the whole run regardless.
+	 *	Outputs are TSV: a per-node time series, a heatmap that averages every window of frames per node location,
+	 *	and a per-node summary with the distance to the nearest actuator for spotting bottlenecks.
+	 */
+	class QueueMonitor
+	{
+	public:
+		struct NodeInfo
+		{
+			int					label_ = 0;
+			int					x_ = 0;
+			int					y_ = 0;
+			int					actuator_distance_ = 0;
+		};
+
+		inline void				configure(int sample_period, std::size_t capacity, std::size_t window);
+		bool					enabled() const							{ return sample_period_ > 0; }
+		bool					due(int time) const						{ return enabled() && time % sample_period_ == 0; }
+
+		inline void				reset(std::vector<NodeInfo> const& nodes);
+		inline QueueSample*		begin_frame(int time);
+		inline void				end_frame();
+		//The frames due in [first, last] while every queue is empty, without sampling each one
+		inline void				zero_frames(int first, int last);
+
+		inline void				write_series(std::ostream& os) const;
+		inline void				write_heatmap(std::ostream& os) const;
+		inline void				write_nodes(std::ostream& os) const;
+
+	private:
+		struct NodeTotals
+		{
+			std::int64_t		inbox_ = 0;
+			std::int64_t		outbox_ = 0;
+			std::int64_t		algorithm_ = 0;
+			int					max_depth_ = 0;
+		};
+
+		//Index of the i-th retained frame, oldest first
+		std::size_t				frame_index(std::size_t i) const		{ return (head_ + capacity_ - count_ + i) % capacity_; }
+		QueueSample const*		frame(std::size_t index) const			{ return &samples_[index * nodes_.size()]; }
+
+		int						sample_period_ = 0;
+		std::size_t				capacity_ = 0;
+		std::size_t				window_ = 1;
+
+		std::vector<NodeInfo>	nodes_;
+		std::vector<QueueSample> samples_;
+		std::vector<int>		times_;
+		std::size_t				head_ = 0;
+		std::size_t				count_ = 0;
+		std::int64_t			frames_total_ = 0;
+		std::vector<NodeTotals>	totals_;
+	};
+
+	inline void QueueMonitor::configure(int sample_period, std::size_t capacity, std::size_t window)
+	{
+		sample_period_ = sample_period;
+		capacity_ = std::max<std::size_t>(capacity, 1);
+		window_ = std::max<std::size_t>(window, 1);
+	}
+
+	inline void QueueMonitor::reset(std::vector<NodeInfo> const& nodes)
+	{
+		nodes_ = nodes;
+		samples_.assign(enabled() ? capacity_ * nodes_.size() : 0, QueueSample());
+		times_.assign(enabled() ? capacity_ : 0, 0);
+		totals_.assign(nodes_.size(), NodeTotals());
+		head_ = 0;
+		count_ = 0;
+		frames_total_ = 0;
+	}
+
+	inline QueueSample* QueueMonitor::begin_frame(int time)
+	{
+		times_[head_] = time;
+		return &samples_[head_ * nodes_.size()];
+	}
+
+	inline void QueueMonitor::end_frame()
+	{
+		QueueSample const* samples = frame(head_);
+		for (std::size_t node = 0; node < nodes_.size(); ++node)
+		{
+			NodeTotals& totals = totals_[node];
+			totals.inbox_ += samples[node].inbox_;
+			totals.outbox_ += samples[node].outbox_;
+			totals.algorithm_ += samples[node].algorithm_;
+			totals.max_depth_ = std::max(totals.max_depth_, samples[node].total());
+		}
+
+		++frames_total_;
+		head_ = (head_ + 1) % capacity_;
+		count_ = std::min(count_ + 1, capacity_);
+	}
+
+	inline void QueueMonitor::zero_frames(int first, int last)
+	{
+		if (!enabled() || last < first)
+		{
+			return;
+		}
+		const int start = (first + sample_period_ - 1) / sample_period_ * sample_period_;
+		if (start > last)
+		{
+			return;
+		}
+
+		//Zero samples leave the per-node totals as they are; only the most recent capacity frames reach the ring
+		const std::int64_t frames = (last - start) / sample_period_ + 1;
+		const std::size_t kept = static_cast<std::size_t>(std::min<std::int64_t>(frames, static_cast<std::int64_t>(capacity_)));
+		int time = start + static_cast<int>(frames - static_cast<std::int64_t>(kept)) * sample_period_;
+		for (std::size_t n = 0; n < kept; ++n, time += sample_period_)
+		{
+			times_[head_] = time;
+			std::fill_n(samples_.begin() + head_ * nodes_.size(), nodes_.size(), QueueSample());
+			head_ = (head_ + 1) % capacity_;
+		}
+		frames_total_ += frames;
+		count_ = std::min(count_ + kept, capacity_);
+	}
+
+	inline void QueueMonitor::write_series(std::ostream& os) const
+	{
+		os << "time\tnode\tx\ty\tinbox\toutbox\talgorithm\n";
+		for (std::size_t i = 0; i < count_; ++i)
+		{
+			const std::size_t index = frame_index(i);
+			QueueSample const* samples = frame(index);
+			for (std::size_t node = 0; node < nodes_.size(); ++node)
+			{
+				os << times_[index] << '\t' << nodes_[node].label_ << '\t' << nodes_[node].x_ << '\t' << nodes_[node].y_ << '\t'
+					<< samples[node].inbox_ << '\t' << samples[node].outbox_ << '\t' << samples[node].algorithm_ << '\n';
+			}
+		}
+	}
+
+	inline void QueueMonitor::write_heatmap(std::ostream& os) const
+	{
+		os << "window_start\twindow_end\tx\ty\tnode\tmean_inbox\tmean_outbox\tmean_algorithm\tmax_depth\n";
+		std::vector<NodeTotals> window(nodes_.size());
+		for (std::size_t first = 0; first < count_; first += window_)
+		{
+			const std::size_t last = std::min(first + window_, count_);
+			std::fill(window.begin(), window.end(), NodeTotals());
+			for (std::size_t i = first; i < last; ++i)
+			{
+				QueueSample const* samples = frame(frame_index(i));
+				for (std::size_t node = 0; node < nodes_.size(); ++node)
+				{
+					window[node].inbox_ += samples[node].inbox_;
+					window[node].outbox_ += samples[node].outbox_;
+					window[node].algorithm_ += samples[node].algorithm_;
+					window[node].max_depth_ = std::max(window[node].max_depth_, samples[node].total());
+				}
+			}
+
+			const double frames = static_cast<double>(last - first);
+			for (std::size_t node = 0; node < nodes_.size(); ++node)
+			{
+				os << times_[frame_index(first)] << '\t' << times_[frame_index(last - 1)] << '\t' << nodes_[node].x_ << '\t' << nodes_[node].y_ << '\t'
+					<< nodes_[node].label_ << '\t' << window[node].inbox_ / frames << '\t' << window[node].outbox_ / frames << '\t'
+					<< window[node].algorithm_ / frames << '\t' << window[node].max_depth_ << '\n';
+			}
+		}
+	}
+
+	inline void QueueMonitor::write_nodes(std::ostream& os) const
+	{
+		//Deepest average queues first
+		std::vector<std::size_t> order(nodes_.size());
+		for (std::size_t node = 0; node < order.size(); ++node)
+		{
+			order[node] = node;
+		}
+		auto mean_depth = [this](std::size_t node) { return totals_[node].inbox_ + totals_[node].outbox_ + totals_[node].algorithm_; };
+		std::stable_sort(order.begin(), order.end(), [&mean_depth](std::size_t a, std::size_t b) { return mean_depth(a) > mean_depth(b); });
+
+		os << "node\tx\ty\tactuator_distance\tsamples\tmean_inbox\tmean_outbox\tmean_algorithm\tmax_depth\n";
+		const double frames = static_cast<double>(std::max<std::int64_t>(frames_total_, 1));
+		for (std::size_t node : order)
+		{
+			os << nodes_[node].label_ << '\t' << nodes_[node].x_ << '\t' << nodes_[node].y_ << '\t' << nodes_[node].actuator_distance_ << '\t'
+				<< frames_total_ << '\t' << totals_[node].inbox_ / frames << '\t' << totals_[node].outbox_ / frames << '\t'
+				<< totals_[node].algorithm_ / frames << '\t' << totals_[node].max_depth_ << '\n';
+		}
+	}
+}
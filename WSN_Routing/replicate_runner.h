@@ -0,0 +1,140 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <ostream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include "run_stats.h"
+
+namespace DC
+{
+	/*
+	 *	Replicates stop once at least min_replicates_ are in and the 95% interval of every metric is within
+	 *	relative_precision_ of its mean, or at max_replicates_.
+	 */
+	struct ReplicateOptions
+	{
+		int						min_replicates_ = 4;
+		int						max_replicates_ = 32;
+		unsigned				first_seed_ = 15;
+		double					relative_precision_ = 0.05;
+		unsigned				thread_count_ = 0;	//0 = one per hardware thread
+	};
+
+	struct ReplicateResult
+	{
+		SampleSummary			delivery_ratio_;
+		SampleSummary			avg_latency_;
+		SampleSummary			energy_mA_;
+		std::vector<RunSummary>	runs_;
+		bool					converged_ = false;
+	};
+
+	/*
+	 *	Runs one configuration with seeds first_seed_, first_seed_ + 1, ... and merges the RunSummaries.
+	 *	run(seed) must build its own algorithm and Environment, since replicates run on several threads at once.
+	 *	Seeds are handed out in batches of one per thread, and results are merged in seed order. The stopping
+	 *	replicate is therefore the same for any thread count; replicates finished past it are discarded.
+	 */
+	class ReplicateRunner
+	{
+	public:
+		explicit				ReplicateRunner(ReplicateOptions const& options) : options_(options) {}
+
+		template<typename Run>
+		inline ReplicateResult	run(Run run) const;
+
+		static inline void		write_header(std::ostream& os);
+		static inline void		write(std::ostream& os, std::string const& name, ReplicateResult const& result);
+
+	private:
+		inline bool				precise(SampleSummary const& metric) const;
+
+		ReplicateOptions		options_;
+	};
+
+	template<typename Run>
+	inline ReplicateResult ReplicateRunner::run(Run run) const
+	{
+		unsigned thread_count = options_.thread_count_ ? options_.thread_count_ : std::thread::hardware_concurrency();
+		thread_count = std::max(1u, thread_count);
+
+		ReplicateResult result;
+		std::vector<RunSummary> batch;
+		while (static_cast<int>(result.runs_.size()) < options_.max_replicates_ && !result.converged_)
+		{
+			const int first = static_cast<int>(result.runs_.size());
+			const int batch_size = std::min(static_cast<int>(thread_count), options_.max_replicates_ - first);
+			batch.assign(batch_size, RunSummary());
+
+			std::atomic<int> next{ 0 };
+			auto work = [&]()
+			{
+				for (int ndx = next++; ndx < batch_size; ndx = next++)
+				{
+					batch[ndx] = run(options_.first_seed_ + static_cast<unsigned>(first + ndx));
+				}
+			};
+			std::vector<std::thread> workers;
+			for (int worker = 1; worker < batch_size; ++worker)
+			{
+				workers.emplace_back(work);
+			}
+			work();
+			for (auto& worker : workers)
+			{
+				worker.join();
+			}
+
+			for (auto& summary : batch)
+			{
+				result.runs_.push_back(summary);
+				result.delivery_ratio_.add(summary.delivery_ratio_);
+				result.avg_latency_.add(summary.avg_latency_);
+				result.energy_mA_.add(summary.energy_mA_);
+				result.converged_ = static_cast<int>(result.runs_.size()) >= options_.min_replicates_ &&
+					precise(result.delivery_ratio_) && precise(result.avg_latency_) && precise(result.energy_mA_);
+				if (result.converged_)
+				{
+					break;
+				}
+			}
+		}
+		return result;
+	}
+
+	inline bool ReplicateRunner::precise(SampleSummary const& metric) const
+	{
+		return metric.half_width() <= options_.relative_precision_ * std::abs(metric.mean());
+	}
+
+	inline void ReplicateRunner::write_header(std::ostream& os)
+	{
+		os << "algorithm" << "\t";
+		os << "replicates" << "\t";
+		os << "converged";
+		for (char const* metric : { "delivery_ratio", "avg_latency", "energy_mA" })
+		{
+			os << "\t" << metric;
+			os << "\t" << metric << "_lower";
+			os << "\t" << metric << "_upper";
+		}
+		os << "\n";
+	}
+
+	inline void ReplicateRunner::write(std::ostream& os, std::string const& name, ReplicateResult const& result)
+	{
+		os << name << "\t";
+		os << result.runs_.size() << "\t";
+		os << result.converged_;
+		for (SampleSummary const* metric : { &result.delivery_ratio_, &result.avg_latency_, &result.energy_mA_ })
+		{
+			os << "\t" << metric->mean();
+			os << "\t" << metric->lower();
+			os << "\t" << metric->upper();
+		}
+		os << "\n";
+	}
+}
@@ -0,0 +1,287 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include <cmath>
+
+namespace DC
+{
+	/*
+	 *	Streaming quantile sketch for non-negative integer samples (latencies in ticks).
+	 *	Values below EXACT_LIMIT get their own bucket; above that each power of two is split into SUB_BUCKETS
+	 *	linear buckets, so a quantile is off by at most 1/SUB_BUCKETS of its value. Memory is fixed and an
+	 *	insert is O(1).
+	 */
+	class LatencySketch
+	{
+	public:
+		inline				LatencySketch();
+
+		inline void			add(int value);
+		inline int			quantile(double q) const;
+		inline void			clear();
+		std::int64_t		count() const								{ return count_; }
+
+	private:
+		static constexpr int EXACT_BITS = 6;
+		static constexpr int EXACT_LIMIT = 1 << EXACT_BITS;
+		static constexpr int SUB_BITS = 5;
+		static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+		static constexpr int MAX_BITS = 31;
+		static constexpr int BUCKET_COUNT = EXACT_LIMIT + (MAX_BITS - EXACT_BITS) * SUB_BUCKETS;
+
+		static inline int	bucket_of(int value);
+		static inline int	bucket_value(int bucket);
+
+		std::vector<std::int64_t> buckets_;
+		std::int64_t		count_ = 0;
+	};
+
+	inline LatencySketch::LatencySketch() : buckets_(BUCKET_COUNT, 0)
+	{
+	}
+
+	inline int LatencySketch::bucket_of(int value)
+	{
+		if (value < EXACT_LIMIT)
+		{
+			return value < 0 ? 0 : value;
+		}
+
+		int exponent = EXACT_BITS;
+		while (exponent < MAX_BITS - 1 && (value >> (exponent + 1)) != 0)
+		{
+			++exponent;
+		}
+		const int sub = (value >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+		return EXACT_LIMIT + (exponent - EXACT_BITS) * SUB_BUCKETS + sub;
+	}
+
+	inline int LatencySketch::bucket_value(int bucket)
+	{
+		if (bucket < EXACT_LIMIT)
+		{
+			return bucket;
+		}
+
+		//Report the middle of the bucket's range
+		const int exponent = EXACT_BITS + (bucket - EXACT_LIMIT) / SUB_BUCKETS;
+		const int sub = (bucket - EXACT_LIMIT) % SUB_BUCKETS;
+		const int width = 1 << (exponent - SUB_BITS);
+		return (1 << exponent) + sub * width + width / 2;
+	}
+
+	inline void LatencySketch::add(int value)
+	{
+		++buckets_[bucket_of(value)];
+		++count_;
+	}
+
+	inline int LatencySketch::quantile(double q) const
+	{
+		if (count_ == 0)
+		{
+			return 0;
+		}
+
+		const std::int64_t rank = static_cast<std::int64_t>(q * static_cast<double>(count_ - 1));
+		std::int64_t seen = 0;
+		for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+		{
+			seen += buckets_[bucket];
+			if (seen > rank)
+			{
+				return bucket_value(bucket);
+			}
+		}
+		return bucket_value(BUCKET_COUNT - 1);
+	}
+
+	inline void LatencySketch::clear()
+	{
+		if (count_ != 0)
+		{
+			std::fill(buckets_.begin(), buckets_.end(), 0);
+			count_ = 0;
+		}
+	}
+
+	/*
+	 *	Running totals kept by the nodes as events happen, plus the aggregates for the window since the last report.
+	 *	Every update is O(1); report() prints one row of the time series and starts a new window.
+	 */
+	struct RunStats
+	{
+		struct counters
+		{
+			std::int64_t	created_ = 0;
+			std::int64_t	sent_ = 0;
+			std::int64_t	received_ = 0;
+			std::int64_t	delivered_ = 0;
+			std::int64_t	dropped_ = 0;
+		};
+
+		counters			totals_;
+		counters			window_;
+		std::int64_t		total_hops_ = 0;
+		std::int64_t		total_latency_ = 0;
+		std::int64_t		window_hops_ = 0;
+		std::int64_t		window_latency_ = 0;
+		LatencySketch		window_latencies_;
+		bool				header_printed_ = false;
+
+		void				on_created()								{ ++totals_.created_; ++window_.created_; }
+		void				on_sent()									{ ++totals_.sent_; ++window_.sent_; }
+		void				on_received()								{ ++totals_.received_; ++window_.received_; }
+		void				on_dropped(int readings)					{ totals_.dropped_ += readings; window_.dropped_ += readings; }
+		inline void			on_delivered(int hop_count, int travel_time);
+
+		inline void			reset();
+		inline void			report(std::ostream& os, int time);
+	};
+
+	inline void RunStats::on_delivered(int hop_count, int travel_time)
+	{
+		++totals_.delivered_;
+		++window_.delivered_;
+		total_hops_ += hop_count;
+		total_latency_ += travel_time;
+		window_hops_ += hop_count;
+		window_latency_ += travel_time;
+		window_latencies_.add(travel_time);
+	}
+
+	inline void RunStats::reset()
+	{
+		totals_ = counters();
+		window_ = counters();
+		total_hops_ = 0;
+		total_latency_ = 0;
+		window_hops_ = 0;
+		window_latency_ = 0;
+		window_latencies_.clear();
+		header_printed_ = false;
+	}
+
+	inline void RunStats::report(std::ostream& os, int time)
+	{
+		if (!header_printed_)
+		{
+			os << "time" << "\t";
+			os << "created" << "\t";
+			os << "sent" << "\t";
+			os << "received" << "\t";
+			os << "delivered" << "\t";
+			os << "dropped" << "\t";
+			os << "win_created" << "\t";
+			os << "win_delivered" << "\t";
+			os << "win_dropped" << "\t";
+			os << "win_delivery_ratio" << "\t";
+			os << "delivery_ratio" << "\t";
+			os << "avg_hops" << "\t";
+			os << "avg_latency" << "\t";
+			os << "p50_latency" << "\t";
+			os << "p90_latency" << "\t";
+			os << "p99_latency" << "\n";
+			header_printed_ = true;
+		}
+
+		const double delivered = static_cast<double>(window_.delivered_);
+		os << time << "\t";
+		os << totals_.created_ << "\t";
+		os << totals_.sent_ << "\t";
+		os << totals_.received_ << "\t";
+		os << totals_.delivered_ << "\t";
+		os << totals_.dropped_ << "\t";
+		os << window_.created_ << "\t";
+		os << window_.delivered_ << "\t";
+		os << window_.dropped_ << "\t";
+		os << (window_.created_ ? delivered / window_.created_ : 0.0) << "\t";
+		os << (totals_.created_ ? static_cast<double>(totals_.delivered_) / totals_.created_ : 0.0) << "\t";
+		os << (window_.delivered_ ? window_hops_ / delivered : 0.0) << "\t";
+		os << (window_.delivered_ ? window_latency_ / delivered : 0.0) << "\t";
+		os << window_latencies_.quantile(0.5) << "\t";
+		os << window_latencies_.quantile(0.9) << "\t";
+		os << window_latencies_.quantile(0.99) << std::endl;
+
+		window_ = counters();
+		window_hops_ = 0;
+		window_latency_ = 0;
+		window_latencies_.clear();
+	}
+
+	/*
+	 *	Whole-run results the Environment fills in at the end of a run, for tools that compare many runs.
+	 *	The backlog (messages queued in all nodes and algorithm queues) is taken halfway through and at the end of
+	 *	message generation; backlog_growth() relates its increase to the messages created in between.
+	 */
+	struct RunSummary
+	{
+		int					ticks_ = 0;
+		std::int64_t		created_ = 0;
+		std::int64_t		delivered_ = 0;
+		std::int64_t		dropped_ = 0;
+		double				delivery_ratio_ = 0;
+		double				avg_hops_ = 0;
+		double				avg_latency_ = 0;
+		double				energy_mA_ = 0;
+		std::int64_t		created_mid_ = 0;
+		std::int64_t		backlog_mid_ = 0;
+		std::int64_t		created_end_ = 0;
+		std::int64_t		backlog_end_ = 0;
+		std::int64_t		log_stalls_ = 0;		//Times a streamed hop log made the simulation wait for its writer
+
+		double				backlog_growth() const
+		{
+			const std::int64_t created = created_end_ - created_mid_;
+			return created > 0 ? static_cast<double>(backlog_end_ - backlog_mid_) / created : 0.0;
+		}
+	};
+
+	/*
+	 *	Mean and sample deviation of a handful of observations (Welford), with a Student-t 95% confidence interval.
+	 */
+	class SampleSummary
+	{
+	public:
+		void				add(double value)
+		{
+			++count_;
+			const double delta = value - mean_;
+			mean_ += delta / count_;
+			m2_ += delta * (value - mean_);
+			min_ = count_ == 1 ? value : std::min(min_, value);
+			max_ = count_ == 1 ? value : std::max(max_, value);
+		}
+
+		int					count() const								{ return count_; }
+		double				mean() const								{ return mean_; }
+		double				min() const									{ return min_; }
+		double				max() const									{ return max_; }
+		double				stddev() const								{ return count_ > 1 ? std::sqrt(m2_ / (count_ - 1)) : 0.0; }
+		double				half_width() const							{ return count_ > 1 ? t95(count_ - 1) * stddev() / std::sqrt(static_cast<double>(count_)) : 0.0; }
+		double				lower() const								{ return mean_ - half_width(); }
+		double				upper() const								{ return mean_ + half_width(); }
+
+		//Two-sided 95% quantile of Student's t distribution
+		static double		t95(int degrees_of_freedom)
+		{
+			static const double table[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+				2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+				2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+			if (degrees_of_freedom < 1)
+			{
+				return 0.0;
+			}
+			return degrees_of_freedom <= 30 ? table[degrees_of_freedom - 1] : 1.96 + 2.4 / degrees_of_freedom;
+		}
+
+	private:
+		int					count_ = 0;
+		double				mean_ = 0;
+		double				m2_ = 0;
+		double				min_ = 0;
+		double				max_ = 0;
+	};
+}
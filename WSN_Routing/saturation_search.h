@@ -0,0 +1,230 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <ostream>
+#include <algorithm>
+#include "run_stats.h"
+
+namespace DC
+{
+	/*
+	 *	A run is sustainable if it delivers at least min_delivery_ratio of what it created and its queues did not keep
+	 *	growing: the backlog may rise by at most max_backlog_growth messages per message created in the second half.
+	 */
+	struct SaturationOptions
+	{
+		int						min_period_ = 100;
+		int						max_period_ = 1500;
+		int						resolution_ = 25;
+		double					min_delivery_ratio_ = 0.9;
+		double					max_backlog_growth_ = 0.1;
+		std::vector<unsigned>	seeds_ = { 15, 16, 17 };
+	};
+
+	struct SaturationRun
+	{
+		unsigned				seed_ = 0;
+		int						sensor_period_ = 0;
+		bool					sustainable_ = false;
+		RunSummary				summary_;
+	};
+
+	/*
+	 *	knee_ summarises, over the seeds, the shortest sensor period that was still sustainable. A seed that is
+	 *	sustainable even at min_period_ counts as min_period_; one that fails at max_period_ is left out and
+	 *	counted in unbounded_seeds_.
+	 */
+	struct SaturationResult
+	{
+		SampleSummary			knee_;
+		int						unbounded_seeds_ = 0;
+		std::vector<SaturationRun> runs_;
+	};
+
+	/*
+	 *	Finds the maximum sustainable offered load by bisecting on the sensor period with the first seed: the
+	 *	bracket [min_period_, max_period_] is narrowed until it is resolution_ ticks wide, which takes about
+	 *	log2((max - min) / resolution) + 2 runs instead of a fixed grid. The other seeds are only run at the two
+	 *	periods that bracket that knee, two runs each; a seed that disagrees with the bracket is bisected further
+	 *	on its own side. run(sensor_period, seed) performs one simulation and returns its RunSummary.
+	 */
+	class SaturationSearch
+	{
+	public:
+		explicit				SaturationSearch(SaturationOptions const& options) : options_(options) {}
+
+		bool					sustainable(RunSummary const& summary) const
+		{
+			return summary.delivery_ratio_ >= options_.min_delivery_ratio_ && summary.backlog_growth() <= options_.max_backlog_growth_;
+		}
+
+		template<typename Run>
+		inline SaturationResult	find(Run run) const;
+
+		static inline void		write_header(std::ostream& os);
+		static inline void		write(std::ostream& os, std::string const& name, SaturationResult const& result);
+		static inline void		write_runs_header(std::ostream& os);
+		static inline void		write_runs(std::ostream& os, std::string const& name, SaturationResult const& result);
+
+	private:
+		SaturationOptions		options_;
+	};
+
+	template<typename Run>
+	inline SaturationResult SaturationSearch::find(Run run) const
+	{
+		SaturationResult result;
+		auto probe = [&](unsigned seed, int period)
+		{
+			//A bracket shared between seeds or searches may ask for a run again
+			for (auto const& attempt : result.runs_)
+			{
+				if (attempt.seed_ == seed && attempt.sensor_period_ == period)
+				{
+					return attempt.sustainable_;
+				}
+			}
+			SaturationRun attempt;
+			attempt.seed_ = seed;
+			attempt.sensor_period_ = period;
+			attempt.summary_ = run(period, seed);
+			attempt.sustainable_ = sustainable(attempt.summary_);
+			result.runs_.push_back(attempt);
+			return attempt.sustainable_;
+		};
+
+		//Invariant: high is sustainable, low is not
+		auto bisect = [&](unsigned seed, int& low, int& high)
+		{
+			while (high - low > options_.resolution_)
+			{
+				const int mid = low + (high - low) / 2;
+				if (probe(seed, mid))
+				{
+					high = mid;
+				}
+				else
+				{
+					low = mid;
+				}
+			}
+		};
+
+		int bracket_low = options_.min_period_;
+		int bracket_high = options_.max_period_;
+		bool bracketed = false;
+		for (unsigned seed : options_.seeds_)
+		{
+			int low = options_.min_period_;
+			int high = options_.max_period_;
+			bool bounded = true;
+			if (!bracketed)
+			{
+				bounded = probe(seed, high);
+				if (bounded && probe(seed, low))
+				{
+					high = low;
+				}
+				else if (bounded)
+				{
+					bisect(seed, low, high);
+					bracket_low = low;
+					bracket_high = high;
+					bracketed = true;
+				}
+			}
+			else
+			{
+				//Step away from the bracket, doubling the step, until it holds for this seed, then bisect
+				low = bracket_low;
+				high = bracket_high;
+				int step = bracket_high - bracket_low;
+				while (!probe(seed, high))
+				{
+					if (high == options_.max_period_)
+					{
+						bounded = false;
+						break;
+					}
+					low = high;
+					high = std::min(options_.max_period_, high + step);
+					step *= 2;
+				}
+				while (bounded && low > options_.min_period_ && probe(seed, low))
+				{
+					high = low;
+					low = std::max(options_.min_period_, low - step);
+					step *= 2;
+				}
+				if (bounded && probe(seed, low))
+				{
+					high = low;
+				}
+				else if (bounded)
+				{
+					bisect(seed, low, high);
+				}
+			}
+
+			if (bounded)
+			{
+				result.knee_.add(high);
+			}
+			else
+			{
+				++result.unbounded_seeds_;
+			}
+		}
+		return result;
+	}
+
+	inline void SaturationSearch::write_header(std::ostream& os)
+	{
+		os << "algorithm" << "\t";
+		os << "seeds" << "\t";
+		os << "unbounded_seeds" << "\t";
+		os << "knee_period" << "\t";
+		os << "knee_period_lower" << "\t";
+		os << "knee_period_upper" << "\t";
+		os << "knee_period_min" << "\t";
+		os << "knee_period_max" << "\t";
+		os << "runs" << "\n";
+	}
+
+	inline void SaturationSearch::write(std::ostream& os, std::string const& name, SaturationResult const& result)
+	{
+		//Offered load per sensor is 1 / period, so the lower period bound is the upper load bound
+		SampleSummary const& knee = result.knee_;
+		os << name << "\t";
+		os << knee.count() + result.unbounded_seeds_ << "\t";
+		os << result.unbounded_seeds_ << "\t";
+		os << knee.mean() << "\t";
+		os << knee.lower() << "\t";
+		os << knee.upper() << "\t";
+		os << knee.min() << "\t";
+		os << knee.max() << "\t";
+		os << result.runs_.size() << "\n";
+	}
+
+	inline void SaturationSearch::write_runs_header(std::ostream& os)
+	{
+		os << "algorithm" << "\t";
+		os << "seed" << "\t";
+		os << "sensor_period" << "\t";
+		os << "sustainable" << "\t";
+		os << "delivery_ratio" << "\t";
+		os << "backlog_growth" << "\t";
+		os << "avg_latency" << "\t";
+		os << "ticks" << "\n";
+	}
+
+	inline void SaturationSearch::write_runs(std::ostream& os, std::string const& name, SaturationResult const& result)
+	{
+		for (auto& attempt : result.runs_)
+		{
+			os << name << "\t" << attempt.seed_ << "\t" << attempt.sensor_period_ << "\t" << attempt.sustainable_ << "\t"
+				<< attempt.summary_.delivery_ratio_ << "\t" << attempt.summary_.backlog_growth() << "\t" << attempt.summary_.avg_latency_ << "\t"
+				<< attempt.summary_.ticks_ << "\n";
+		}
+	}
+}
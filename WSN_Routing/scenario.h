@@ -0,0 +1,461 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <ostream>
+#include <fstream>
+#include <sstream>
+#include "topology.h"
+#include "topology_generator.h"
+#include "destination_policy.h"
+#include "columnar_log.h"
+#include "mapped_file.h"
+
+/*
+ *	Scenario text format: one directive per line, words separated by blanks, '#' starts a comment.
+ *
+ *		field <x_dim> <y_dim>
+ *		comm_range <range>
+ *		layout grid|hex|uniform|poisson|clustered		see TopologyOptions
+ *		node_distance <spacing>
+ *		node_count <count>
+ *		clusters <count> <spread>
+ *		actuators <count> [first|centre|corners|kmeans]
+ *		seed <seed>										for the layout and the runs
+ *		node <x> <y>									explicit positions instead of a layout, node index = line order
+ *		actuator <node index>							explicit actuators instead of a placement
+ *		sensor_period <period>...						the default sensor period; one run per value
+ *		zone <x0> <y0> <x1> <y1> <from> <period>		nodes in [x0, x1) x [y0, y1) sense every period ticks from tick from on
+ *		algorithm <name>...								algorithms to run, by the names main() knows
+ *		destinations random|nearest|least_loaded|anycast
+ *		messages <count>
+ *		update_timeframe <ticks>
+ *		param <key> <value>								anything else an algorithm reads, e.g. param fusion concat
+ *
+ *	Binary variant (all integers little-endian), for layouts too large to parse as text:
+ *		char[8]		magic "WSNSCN1\0"
+ *		uint32		version
+ *		uint32		text size in bytes
+ *		uint32		node count
+ *		uint32		actuator count
+ *		char[]		every directive except node and actuator, in the text format, zero padded to a multiple of 8
+ *		int32[2]	x and y of every node
+ *		uint32[]	the actuator node indices
+ *	Positions and actuators are copied straight out of the memory mapping.
+ */
+
+namespace DC
+{
+	//From tick from_ on, the nodes in [x0_, x1_) x [y0_, y1_) sense every period_ ticks; later zones win where they overlap
+	struct LoadZone
+	{
+		int						x0_ = 0;
+		int						y0_ = 0;
+		int						x1_ = 0;
+		int						y1_ = 0;
+		int						from_ = 0;
+		int						period_ = 0;
+
+		bool					contains(coordinates const& position) const
+		{
+			return position.x_ >= x0_ && position.x_ < x1_ && position.y_ >= y0_ && position.y_ < y1_;
+		}
+	};
+
+	class Scenario
+	{
+	public:
+		using Index				= Topology::Index;
+
+		TopologyOptions			topology_;
+		std::vector<coordinates> positions_;					//Explicit positions; empty to generate them from topology_
+		std::vector<Index>		actuators_;						//Explicit actuators; empty to place them per topology_
+		std::vector<int>		sensor_periods_ = { 300 };
+		std::vector<LoadZone>	zones_;
+		std::vector<std::string> algorithms_;
+		std::map<std::string, std::string> params_;
+		DestinationPolicy		destination_policy_ = DestinationPolicy::random;
+		int						messages_ = 15000;
+		int						update_timeframe_ = 10000;
+		unsigned				seed_ = 15;
+
+		static constexpr std::size_t	MAGIC_LENGTH = 8;
+		static constexpr std::uint32_t	VERSION = 1;
+		static constexpr std::size_t	ALIGNMENT = 8;
+		static char const*		magic()											{ return "WSNSCN1"; } // MAGIC_LENGTH bytes with the terminator
+
+		//Reads either format; on failure error says what and where
+		static inline bool		load(std::string const& file_name, Scenario& scenario, std::string& error);
+		static inline bool		parse(char const* data, std::size_t size, Scenario& scenario, std::string& error);
+
+		//Every directive except node and actuator
+		inline void				write_settings(std::ostream& os) const;
+		inline bool				write_binary(std::string const& file_name) const;
+
+		//nullptr, with error set, if an explicit actuator is not a node or the network is partitioned
+		inline Topology::Ptr	topology(std::string& error) const;
+		std::string				param(std::string const& key, std::string const& fallback) const
+		{
+			auto found = params_.find(key);
+			return found != params_.end() ? found->second : fallback;
+		}
+
+	private:
+		static inline bool		parse_line(std::vector<std::string> const& words, Scenario& scenario, std::string& error);
+		static inline bool		to_int(std::string const& word, long long min, long long max, long long& value);
+	};
+
+	inline bool Scenario::load(std::string const& file_name, Scenario& scenario, std::string& error)
+	{
+		MappedFile file{ file_name };
+		if (!file.is_open())
+		{
+			error = "cannot open " + file_name;
+			return false;
+		}
+		if (file.size() < MAGIC_LENGTH || std::memcmp(file.data(), magic(), MAGIC_LENGTH) != 0)
+		{
+			return parse(file.data(), file.size(), scenario, error);
+		}
+
+		const std::size_t header_size = MAGIC_LENGTH + 4 * sizeof(std::uint32_t);
+		if (file.size() < header_size || ColumnarLog::get_u32(file.data() + MAGIC_LENGTH) != VERSION)
+		{
+			error = file_name + " is not a version " + std::to_string(VERSION) + " binary scenario";
+			return false;
+		}
+		const std::size_t text_size = ColumnarLog::get_u32(file.data() + MAGIC_LENGTH + 4);
+		const std::size_t node_count = ColumnarLog::get_u32(file.data() + MAGIC_LENGTH + 8);
+		const std::size_t actuator_count = ColumnarLog::get_u32(file.data() + MAGIC_LENGTH + 12);
+		const std::size_t padded_text = (text_size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		if (file.size() != header_size + padded_text + node_count * 2 * sizeof(std::int32_t) + actuator_count * sizeof(std::uint32_t))
+		{
+			error = file_name + " is truncated";
+			return false;
+		}
+		char const* text = file.data() + header_size;
+		if (!parse(text, text_size, scenario, error))
+		{
+			return false;
+		}
+
+		//Both formats are little-endian and so is every platform this builds for, so the arrays are copied as they are
+		static_assert(sizeof(coordinates) == 2 * sizeof(std::int32_t), "coordinates must be two packed 32-bit ints");
+		scenario.positions_.resize(node_count);
+		scenario.actuators_.resize(actuator_count);
+		if (node_count != 0)
+		{
+			std::memcpy(scenario.positions_.data(), text + padded_text, node_count * sizeof(coordinates));
+		}
+		if (actuator_count != 0)
+		{
+			std::memcpy(scenario.actuators_.data(), text + padded_text + node_count * sizeof(coordinates), actuator_count * sizeof(Index));
+		}
+		return true;
+	}
+
+	inline bool Scenario::parse(char const* data, std::size_t size, Scenario& scenario, std::string& error)
+	{
+		std::vector<std::string> words;
+		int line = 0;
+		bool periods_given = false;
+		for (std::size_t at = 0; at < size; )
+		{
+			++line;
+			words.clear();
+			bool comment = false;
+			while (at < size && data[at] != '\n')
+			{
+				if (data[at] == ' ' || data[at] == '\t' || data[at] == '\r')
+				{
+					++at;
+					continue;
+				}
+				const std::size_t start = at;
+				while (at < size && data[at] != ' ' && data[at] != '\t' && data[at] != '\r' && data[at] != '\n')
+				{
+					++at;
+				}
+				comment = comment || data[start] == '#';
+				if (!comment)
+				{
+					words.emplace_back(data + start, at - start);
+				}
+			}
+			++at;
+			if (words.empty())
+			{
+				continue;
+			}
+
+			//The first sensor_period line replaces the default instead of adding to it
+			if (words[0] == "sensor_period" && !periods_given)
+			{
+				scenario.sensor_periods_.clear();
+				periods_given = true;
+			}
+			if (!parse_line(words, scenario, error))
+			{
+				error = "line " + std::to_string(line) + ": " + error;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline bool Scenario::to_int(std::string const& word, long long min, long long max, long long& value)
+	{
+		char* end = nullptr;
+		value = std::strtoll(word.c_str(), &end, 10);
+		return !word.empty() && *end == '\0' && value >= min && value <= max;
+	}
+
+	inline bool Scenario::parse_line(std::vector<std::string> const& words, Scenario& scenario, std::string& error)
+	{
+		std::string const& key = words[0];
+		const std::size_t count = words.size() - 1;
+		std::vector<long long> values(count);
+		auto numbers = [&](std::size_t min_count, std::size_t max_count, long long min, long long max)
+		{
+			if (count < min_count || count > max_count)
+			{
+				error = key + " takes " + std::to_string(min_count) + (min_count == max_count ? "" : " or more") + " values";
+				return false;
+			}
+			for (std::size_t ndx = 0; ndx < count; ++ndx)
+			{
+				if (!to_int(words[ndx + 1], min, max, values[ndx]))
+				{
+					error = "bad value " + words[ndx + 1] + " for " + key;
+					return false;
+				}
+			}
+			return true;
+		};
+		auto name = [&]()
+		{
+			if (count != 1)
+			{
+				error = key + " takes one value";
+				return false;
+			}
+			return true;
+		};
+
+		const long long big = 0x7FFFFFFF;
+		TopologyOptions& topology = scenario.topology_;
+		if (key == "field")
+		{
+			if (!numbers(2, 2, 1, big)) return false;
+			topology.x_dim_ = static_cast<int>(values[0]);
+			topology.y_dim_ = static_cast<int>(values[1]);
+		}
+		else if (key == "comm_range")
+		{
+			if (!numbers(1, 1, 0, big)) return false;
+			topology.comm_range_ = static_cast<int>(values[0]);
+		}
+		else if (key == "layout")
+		{
+			if (!name()) return false;
+			if (!parse_layout(words[1], topology.layout_))
+			{
+				error = "unknown layout " + words[1];
+				return false;
+			}
+		}
+		else if (key == "node_distance")
+		{
+			if (!numbers(1, 1, 1, big)) return false;
+			topology.node_distance_ = static_cast<int>(values[0]);
+		}
+		else if (key == "node_count")
+		{
+			if (!numbers(1, 1, 0, 0xFFFFFFFE)) return false;
+			topology.node_count_ = static_cast<std::size_t>(values[0]);
+		}
+		else if (key == "clusters")
+		{
+			if (!numbers(2, 2, 1, big)) return false;
+			topology.cluster_count_ = static_cast<int>(values[0]);
+			topology.cluster_spread_ = static_cast<double>(values[1]);
+		}
+		else if (key == "actuators")
+		{
+			if (count == 2 && !parse_actuator_placement(words[2], topology.placement_))
+			{
+				error = "unknown actuator placement " + words[2];
+				return false;
+			}
+			if (count < 1 || count > 2 || !to_int(words[1], 0, big, values[0]))
+			{
+				error = "actuators takes a count and optionally a placement";
+				return false;
+			}
+			topology.actuator_count_ = static_cast<int>(values[0]);
+		}
+		else if (key == "seed")
+		{
+			if (!numbers(1, 1, 0, 0xFFFFFFFF)) return false;
+			scenario.seed_ = static_cast<unsigned>(values[0]);
+			topology.seed_ = scenario.seed_;
+		}
+		else if (key == "node")
+		{
+			if (!numbers(2, 2, -big, big)) return false;
+			scenario.positions_.push_back(coordinates(static_cast<int>(values[0]), static_cast<int>(values[1])));
+		}
+		else if (key == "actuator")
+		{
+			if (!numbers(1, 1, 0, 0xFFFFFFFE)) return false;
+			scenario.actuators_.push_back(static_cast<Index>(values[0]));
+		}
+		else if (key == "sensor_period")
+		{
+			if (!numbers(1, ~std::size_t(0), 1, big)) return false;
+			scenario.sensor_periods_.insert(scenario.sensor_periods_.end(), values.begin(), values.end());
+		}
+		else if (key == "zone")
+		{
+			if (!numbers(6, 6, -big, big)) return false;
+			LoadZone zone;
+			zone.x0_ = static_cast<int>(values[0]);
+			zone.y0_ = static_cast<int>(values[1]);
+			zone.x1_ = static_cast<int>(values[2]);
+			zone.y1_ = static_cast<int>(values[3]);
+			zone.from_ = static_cast<int>(values[4]);
+			zone.period_ = static_cast<int>(values[5]);
+			if (zone.from_ < 0 || zone.period_ < 1)
+			{
+				error = "zone needs a start tick >= 0 and a period >= 1";
+				return false;
+			}
+			scenario.zones_.push_back(zone);
+		}
+		else if (key == "algorithm")
+		{
+			if (count == 0)
+			{
+				error = "algorithm takes one or more names";
+				return false;
+			}
+			scenario.algorithms_.insert(scenario.algorithms_.end(), words.begin() + 1, words.end());
+		}
+		else if (key == "destinations")
+		{
+			if (!name()) return false;
+			if (!parse_destination_policy(words[1], scenario.destination_policy_))
+			{
+				error = "unknown destination policy " + words[1];
+				return false;
+			}
+		}
+		else if (key == "messages")
+		{
+			if (!numbers(1, 1, 1, big)) return false;
+			scenario.messages_ = static_cast<int>(values[0]);
+		}
+		else if (key == "update_timeframe")
+		{
+			if (!numbers(1, 1, 1, big)) return false;
+			scenario.update_timeframe_ = static_cast<int>(values[0]);
+		}
+		else if (key == "param")
+		{
+			if (count != 2)
+			{
+				error = "param takes a key and a value";
+				return false;
+			}
+			scenario.params_[words[1]] = words[2];
+		}
+		else
+		{
+			error = "unknown directive " + key;
+			return false;
+		}
+		return true;
+	}
+
+	inline void Scenario::write_settings(std::ostream& os) const
+	{
+		static const char* const layouts[] = { "grid", "hex", "uniform", "poisson", "clustered" };
+		static const char* const placements[] = { "first", "centre", "corners", "kmeans" };
+		static const char* const policies[] = { "random", "nearest", "least_loaded", "anycast" };
+		os << "field " << topology_.x_dim_ << " " << topology_.y_dim_ << "\n";
+		os << "comm_range " << topology_.comm_range_ << "\n";
+		os << "layout " << layouts[static_cast<int>(topology_.layout_)] << "\n";
+		os << "node_distance " << topology_.node_distance_ << "\n";
+		os << "node_count " << topology_.node_count_ << "\n";
+		os << "clusters " << topology_.cluster_count_ << " " << static_cast<long long>(topology_.cluster_spread_) << "\n";
+		os << "actuators " << topology_.actuator_count_ << " " << placements[static_cast<int>(topology_.placement_)] << "\n";
+		os << "seed " << seed_ << "\n";
+		os << "sensor_period";
+		for (int period : sensor_periods_)
+		{
+			os << " " << period;
+		}
+		os << "\n";
+		for (auto const& zone : zones_)
+		{
+			os << "zone " << zone.x0_ << " " << zone.y0_ << " " << zone.x1_ << " " << zone.y1_ << " " << zone.from_ << " " << zone.period_ << "\n";
+		}
+		for (auto const& algorithm : algorithms_)
+		{
+			os << "algorithm " << algorithm << "\n";
+		}
+		os << "destinations " << policies[static_cast<int>(destination_policy_)] << "\n";
+		os << "messages " << messages_ << "\n";
+		os << "update_timeframe " << update_timeframe_ << "\n";
+		for (auto const& param : params_)
+		{
+			os << "param " << param.first << " " << param.second << "\n";
+		}
+	}
+
+	inline bool Scenario::write_binary(std::string const& file_name) const
+	{
+		std::ostringstream settings;
+		write_settings(settings);
+		const std::string text = settings.str();
+
+		std::string header(magic(), MAGIC_LENGTH);
+		ColumnarLog::put_u32(header, VERSION);
+		ColumnarLog::put_u32(header, static_cast<std::uint32_t>(text.size()));
+		ColumnarLog::put_u32(header, static_cast<std::uint32_t>(positions_.size()));
+		ColumnarLog::put_u32(header, static_cast<std::uint32_t>(actuators_.size()));
+		header += text;
+		header.append((ALIGNMENT - header.size() % ALIGNMENT) % ALIGNMENT, '\0');
+
+		std::ofstream os{ file_name, std::ios::binary };
+		os.write(header.data(), static_cast<std::streamsize>(header.size()));
+		os.write(reinterpret_cast<char const*>(positions_.data()), static_cast<std::streamsize>(positions_.size() * sizeof(coordinates)));
+		os.write(reinterpret_cast<char const*>(actuators_.data()), static_cast<std::streamsize>(actuators_.size() * sizeof(Index)));
+		return static_cast<bool>(os);
+	}
+
+	inline Topology::Ptr Scenario::topology(std::string& error) const
+	{
+		std::vector<coordinates> positions = positions_.empty() ? TopologyGenerator::positions(topology_) : positions_;
+		std::vector<Index> actuators = actuators_.empty() ? TopologyGenerator::place_actuators(positions, topology_) : actuators_;
+		for (Index actuator : actuators)
+		{
+			if (actuator >= positions.size())
+			{
+				error = "actuator " + std::to_string(actuator) + " is not a node";
+				return nullptr;
+			}
+		}
+		Topology::Ptr topology = std::make_shared<const Topology>(std::move(positions), std::move(actuators), topology_.comm_range_, topology_.x_dim_, topology_.y_dim_);
+		//A partitioned layout strands every reading of the nodes cut off from the sinks, which reads as a routing failure
+		if (!TopologyGenerator::connected(*topology))
+		{
+			error = "the network is partitioned at comm range " + std::to_string(topology_.comm_range_);
+			return nullptr;
+		}
+		return topology;
+	}
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <functional>
+#include <cassert>
+
+namespace DC
+{
+	/*
+	 *	Keeps the next sensing time of every sensor node in a min-heap, so the environment only touches the nodes
+	 *	that actually sense on a given tick instead of evaluating (time + label) % sensor_period for every node.
+	 *
+	 *	A node senses at time t when (t + label) % period == 0, which is exactly the check the run loops used to do.
+	 *	Changing a node's period bumps its generation; older heap entries for that node are skipped when popped.
+	 */
+	class SensorCalendar
+	{
+	public:
+		SensorCalendar() = default;
+
+		inline void			reset(int slot_count);
+		inline void			schedule(int slot, int label, int period, int from_time);
+		inline void			set_period(int slot, int period, int from_time);
+		inline void			pop_due(int now, std::vector<int>& due);
+		//Moves every node past ticks that are skipped instead of visited; nothing senses in them
+		inline void			skip_to(int time);
+		inline int			next_event();
+		inline bool			empty()												{ return next_event() == NO_EVENT; }
+
+		static constexpr int NO_EVENT = -1;
+
+	private:
+		struct event
+		{
+			int time_ = 0;
+			int slot_ = 0;
+			int generation_ = 0;
+
+			event() = default;
+			event(int time, int slot, int generation) : time_(time), slot_(slot), generation_(generation) {}
+
+			// Ties are broken by slot so nodes that sense on the same tick come out in node order
+			bool operator>(event const& other) const
+			{
+				return time_ != other.time_ ? time_ > other.time_ : slot_ > other.slot_;
+			}
+		};
+
+		struct slot_state
+		{
+			int label_ = 0;
+			int period_ = 0;
+			int generation_ = 0;
+			bool scheduled_ = false;
+		};
+
+		static int			next_trigger(int label, int period, int from_time);
+		inline void			drop_stale();
+
+		std::priority_queue<event, std::vector<event>, std::greater<event>> events_;
+		std::vector<slot_state> slots_;
+	};
+
+	inline void SensorCalendar::reset(int slot_count)
+	{
+		events_ = decltype(events_)();
+		slots_.assign(slot_count, slot_state());
+	}
+
+	inline int SensorCalendar::next_trigger(int label, int period, int from_time)
+	{
+		//First time t >= from_time with (t + label) % period == 0
+		assert(period > 0);
+		const int remainder = (from_time + label) % period;
+		return remainder == 0 ? from_time : from_time + (period - remainder);
+	}
+
+	inline void SensorCalendar::schedule(int slot, int label, int period, int from_time)
+	{
+		slot_state& state = slots_[slot];
+		state.label_ = label;
+		state.period_ = period;
+		state.scheduled_ = true;
+		++state.generation_;
+		events_.push(event(next_trigger(label, period, from_time), slot, state.generation_));
+	}
+
+	inline void SensorCalendar::set_period(int slot, int period, int from_time)
+	{
+		slot_state& state = slots_[slot];
+		if (!state.scheduled_ || state.period_ == period)
+		{
+			//Same period means the same trigger sequence; the pending event is still correct
+			return;
+		}
+		schedule(slot, state.label_, period, from_time);
+	}
+
+	inline void SensorCalendar::drop_stale()
+	{
+		while (!events_.empty() && events_.top().generation_ != slots_[events_.top().slot_].generation_)
+		{
+			events_.pop();
+		}
+	}
+
+	inline void SensorCalendar::pop_due(int now, std::vector<int>& due)
+	{
+		drop_stale();
+		while (!events_.empty() && events_.top().time_ <= now)
+		{
+			event ev = events_.top();
+			events_.pop();
+			assert(ev.time_ == now); //Every tick is visited or skipped with skip_to, so nothing should be left behind
+			slot_state const& state = slots_[ev.slot_];
+			due.push_back(ev.slot_);
+			events_.push(event(ev.time_ + state.period_, ev.slot_, ev.generation_));
+			drop_stale();
+		}
+	}
+
+	inline void SensorCalendar::skip_to(int time)
+	{
+		drop_stale();
+		while (!events_.empty() && events_.top().time_ < time)
+		{
+			event ev = events_.top();
+			events_.pop();
+			slot_state const& state = slots_[ev.slot_];
+			events_.push(event(next_trigger(state.label_, state.period_, time), ev.slot_, ev.generation_));
+			drop_stale();
+		}
+	}
+
+	inline int SensorCalendar::next_event()
+	{
+		drop_stale();
+		return events_.empty() ? NO_EVENT : events_.top().time_;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+
+namespace DC
+{
+	/*
+	 *	Per-simulation random numbers, so Environments on different threads do not share the C library's rand() state.
+	 *	It uses the same generator and 0..32767 range as the MSVC rand(), so a run seeded with s reproduces what
+	 *	std::srand(s) followed by std::rand() gave there.
+	 */
+	class SimRandom
+	{
+	public:
+		static constexpr int	MAX = 0x7FFF;
+
+		explicit				SimRandom(unsigned seed = 1) : state_(seed) {}
+
+		void					seed(unsigned seed)						{ state_ = seed; }
+		int						next()
+		{
+			state_ = state_ * 214013u + 2531011u;
+			return static_cast<int>((state_ >> 16) & MAX);
+		}
+
+	private:
+		std::uint32_t			state_;
+	};
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cassert>
+
+namespace DC
+{
+	/*
+	 *	Fixed-capacity single-producer/single-consumer ring.
+	 *	One thread may call try_push and one other thread may call try_pop; neither ever takes a lock.
+	 */
+	template<typename T>
+	class SpscRing
+	{
+	public:
+		inline explicit			SpscRing(std::size_t capacity);
+								SpscRing(SpscRing const& other) = delete;
+		SpscRing&				operator=(SpscRing const& other) = delete;
+
+		inline bool				try_push(T const& value);
+		inline bool				try_pop(T& value);
+		inline bool				empty() const;
+		std::size_t				capacity() const						{ return slots_.size() - 1; }
+
+	private:
+		std::vector<T>			slots_;
+		std::atomic<std::size_t> head_{ 0 };	//Next slot to pop, written by the consumer
+		std::atomic<std::size_t> tail_{ 0 };	//Next slot to push, written by the producer
+	};
+
+	template<typename T>
+	inline SpscRing<T>::SpscRing(std::size_t capacity) : slots_(capacity + 1)
+	{
+		//One slot stays empty so that head_ == tail_ always means "empty"
+		assert(capacity > 0);
+	}
+
+	template<typename T>
+	inline bool SpscRing<T>::try_push(T const& value)
+	{
+		const std::size_t tail = tail_.load(std::memory_order_relaxed);
+		const std::size_t next = tail + 1 == slots_.size() ? 0 : tail + 1;
+		if (next == head_.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		slots_[tail] = value;
+		tail_.store(next, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	inline bool SpscRing<T>::try_pop(T& value)
+	{
+		const std::size_t head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		value = slots_[head];
+		head_.store(head + 1 == slots_.size() ? 0 : head + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	inline bool SpscRing<T>::empty() const
+	{
+		return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+	}
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include "node.hpp"
+
+namespace DC
+{
+	/*
+	 *	Node positions, the actuator set and the physical neighbor lists of a network, built once and shared
+	 *	(read-only) by every Environment of a sweep, also across threads. Node index i is the node labelled i + 1.
+	 *	Neighbors are stored as compressed sparse rows: the neighbors of node i are
+	 *	neighbors()[offsets()[i] .. offsets()[i + 1]), in increasing index order.
+	 *	Two nodes are neighbors when Node::distance_to (the truncated Euclidean distance) is at most comm_range;
+	 *	the search buckets nodes into cells of comm_range + 1, so it is O(N) for bounded density instead of O(N^2).
+	 */
+	class Topology
+	{
+	public:
+		using Index				= std::uint32_t;
+		using Ptr				= std::shared_ptr<const Topology>;
+
+		inline					Topology(std::vector<coordinates> positions, std::vector<Index> actuators, int comm_range, int x_dim, int y_dim);
+
+		//The layout Environment always used: a node every node_distance on [0, x_dim) x [0, y_dim), column by column,
+		//with the first actuator_count nodes as actuators
+		static inline Ptr		grid(int node_distance, int x_dim, int y_dim, int actuator_count, int comm_range);
+
+		std::size_t				size() const							{ return positions_.size(); }
+		coordinates const&		position(Index node) const				{ return positions_[node]; }
+		std::vector<Index> const& actuators() const						{ return actuators_; }
+		bool					is_actuator(Index node) const			{ return is_actuator_[node] != 0; }
+		int						comm_range() const						{ return comm_range_; }
+		int						x_dim() const							{ return x_dim_; }
+		int						y_dim() const							{ return y_dim_; }
+
+		std::vector<Index> const& offsets() const						{ return offsets_; }
+		std::vector<Index> const& neighbors() const						{ return neighbors_; }
+		Index const*			neighbors_begin(Index node) const		{ return neighbors_.data() + offsets_[node]; }
+		Index const*			neighbors_end(Index node) const			{ return neighbors_.data() + offsets_[node + 1]; }
+
+	private:
+		inline void				build_adjacency();
+
+		std::vector<coordinates> positions_;
+		std::vector<Index>		actuators_;
+		std::vector<char>		is_actuator_;
+		int						comm_range_;
+		int						x_dim_;
+		int						y_dim_;
+		std::vector<Index>		offsets_;
+		std::vector<Index>		neighbors_;
+	};
+
+	inline Topology::Topology(std::vector<coordinates> positions, std::vector<Index> actuators, int comm_range, int x_dim, int y_dim) :
+		positions_(std::move(positions)), actuators_(std::move(actuators)), comm_range_(comm_range), x_dim_(x_dim), y_dim_(y_dim)
+	{
+		is_actuator_.assign(positions_.size(), 0);
+		for (Index actuator : actuators_)
+		{
+			assert(actuator < positions_.size());
+			is_actuator_[actuator] = 1;
+		}
+		build_adjacency();
+	}
+
+	inline Topology::Ptr Topology::grid(int node_distance, int x_dim, int y_dim, int actuator_count, int comm_range)
+	{
+		std::vector<coordinates> positions;
+		for (int x = 0; x < x_dim; x += node_distance)
+		{
+			for (int y = 0; y < y_dim; y += node_distance)
+			{
+				positions.push_back(coordinates(x, y));
+			}
+		}
+		assert(actuator_count < static_cast<int>(positions.size()));
+
+		std::vector<Index> actuators;
+		for (int act_ndx = 0; act_ndx < actuator_count; ++act_ndx)
+		{
+			actuators.push_back(static_cast<Index>(act_ndx));
+		}
+		return std::make_shared<const Topology>(std::move(positions), std::move(actuators), comm_range, x_dim, y_dim);
+	}
+
+	inline void Topology::build_adjacency()
+	{
+		const std::size_t node_count = positions_.size();
+		offsets_.assign(node_count + 1, 0);
+		neighbors_.clear();
+		if (node_count == 0)
+		{
+			return;
+		}
+
+		//floor(sqrt(d2)) <= comm_range exactly when d2 < (comm_range + 1)^2
+		const std::int64_t reach = static_cast<std::int64_t>(comm_range_) + 1;
+		const std::int64_t limit = reach * reach;
+
+		int min_x = positions_[0].x_, max_x = min_x, min_y = positions_[0].y_, max_y = min_y;
+		for (auto& p : positions_)
+		{
+			min_x = std::min(min_x, p.x_);
+			max_x = std::max(max_x, p.x_);
+			min_y = std::min(min_y, p.y_);
+			max_y = std::max(max_y, p.y_);
+		}
+		const int cell = static_cast<int>(reach);
+		const int columns = (max_x - min_x) / cell + 1;
+		const int rows = (max_y - min_y) / cell + 1;
+
+		//Bucket the nodes by cell (counting sort, so each cell lists its nodes in index order)
+		std::vector<Index> cell_start(static_cast<std::size_t>(columns) * rows + 1, 0);
+		std::vector<Index> node_cell(node_count);
+		for (Index node = 0; node < node_count; ++node)
+		{
+			node_cell[node] = static_cast<Index>(((positions_[node].x_ - min_x) / cell) * rows + (positions_[node].y_ - min_y) / cell);
+			++cell_start[node_cell[node] + 1];
+		}
+		for (std::size_t c = 1; c < cell_start.size(); ++c)
+		{
+			cell_start[c] += cell_start[c - 1];
+		}
+		std::vector<Index> cell_nodes(node_count);
+		std::vector<Index> fill(cell_start.begin(), cell_start.end() - 1);
+		for (Index node = 0; node < node_count; ++node)
+		{
+			cell_nodes[fill[node_cell[node]]++] = node;
+		}
+
+		std::vector<Index> found;
+		for (Index node = 0; node < node_count; ++node)
+		{
+			found.clear();
+			const int column = static_cast<int>(node_cell[node]) / rows;
+			const int row = static_cast<int>(node_cell[node]) % rows;
+			for (int c = std::max(column - 1, 0); c <= std::min(column + 1, columns - 1); ++c)
+			{
+				for (int r = std::max(row - 1, 0); r <= std::min(row + 1, rows - 1); ++r)
+				{
+					const std::size_t bucket = static_cast<std::size_t>(c) * rows + r;
+					for (Index ndx = cell_start[bucket]; ndx < cell_start[bucket + 1]; ++ndx)
+					{
+						const Index other = cell_nodes[ndx];
+						const std::int64_t dx = positions_[node].x_ - positions_[other].x_;
+						const std::int64_t dy = positions_[node].y_ - positions_[other].y_;
+						if (other != node && dx * dx + dy * dy < limit)
+						{
+							found.push_back(other);
+						}
+					}
+				}
+			}
+			std::sort(found.begin(), found.end());
+			neighbors_.insert(neighbors_.end(), found.begin(), found.end());
+			offsets_[node + 1] = static_cast<Index>(neighbors_.size());
+		}
+	}
+}
@@ -0,0 +1,376 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include "topology.h"
+
+namespace DC
+{
+	enum class Layout
+	{
+		grid,				//A node every node_distance_, column by column (Topology::grid)
+		hex,				//Rows node_distance_ * sqrt(3) / 2 apart, every other row shifted by half a spacing
+		uniform,			//node_count_ nodes uniformly at random (a random geometric graph)
+		poisson,			//A Poisson number of nodes, node_count_ on average, uniformly at random
+		clustered			//node_count_ nodes around cluster_count_ random centres, Gaussian with cluster_spread_ (a Thomas process)
+	};
+
+	enum class ActuatorPlacement
+	{
+		first,				//The first actuator_count_ nodes, as Topology::grid does
+		centre,				//The nodes nearest the centre of the field
+		corners,			//The nodes nearest the corners, in turn
+		kmeans				//The nodes nearest the centroids of a k-means clustering of all positions
+	};
+
+	inline bool parse_layout(std::string const& name, Layout& layout)
+	{
+		static const char* const names[] = { "grid", "hex", "uniform", "poisson", "clustered" };
+		for (int ndx = 0; ndx < 5; ++ndx)
+		{
+			if (name == names[ndx])
+			{
+				layout = static_cast<Layout>(ndx);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline bool parse_actuator_placement(std::string const& name, ActuatorPlacement& placement)
+	{
+		static const char* const names[] = { "first", "centre", "corners", "kmeans" };
+		for (int ndx = 0; ndx < 4; ++ndx)
+		{
+			if (name == names[ndx])
+			{
+				placement = static_cast<ActuatorPlacement>(ndx);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	struct TopologyOptions
+	{
+		Layout					layout_ = Layout::grid;
+		int						x_dim_ = 40;
+		int						y_dim_ = 40;
+		int						node_distance_ = 5;		//grid and hex
+		std::size_t				node_count_ = 64;		//uniform, poisson and clustered
+		int						cluster_count_ = 8;		//clustered
+		double					cluster_spread_ = 10;	//clustered
+		int						comm_range_ = 10;
+		int						actuator_count_ = 4;
+		ActuatorPlacement		placement_ = ActuatorPlacement::first;
+		int						kmeans_iterations_ = 10;
+		unsigned				seed_ = 15;
+	};
+
+	/*
+	 *	Builds Topologies for larger and less regular deployments than the default grid. Positions are integer
+	 *	coordinates on [0, x_dim_) x [0, y_dim_). Random layouts draw from std::mt19937 with their own integer and
+	 *	Gaussian transforms, since the standard distributions differ between library implementations, so a seed gives
+	 *	the same network on every platform. Positions, actuator placement and the connectivity check are O(N) passes
+	 *	(O(N log N) for sorting random layouts, O(N k) for k-means) and take well under a second for 10^6 nodes.
+	 */
+	class TopologyGenerator
+	{
+	public:
+		using Index				= Topology::Index;
+
+		static inline Topology::Ptr generate(TopologyOptions const& options);
+		//Tries seed_, seed_ + 1, ... until the network is connected; nullptr after attempts tries
+		static inline Topology::Ptr generate_connected(TopologyOptions options, int attempts);
+
+		static inline std::vector<coordinates> positions(TopologyOptions const& options);
+		static inline std::vector<Index> place_actuators(std::vector<coordinates> const& positions, TopologyOptions const& options);
+		//Whether every node can reach every other over the neighbor graph
+		static inline bool		connected(Topology const& topology);
+
+	private:
+		static double			uniform(std::mt19937& rng)					{ return (rng() >> 5) * (1.0 / 134217728.0); }	//[0, 1) from 27 bits
+		static int				uniform(std::mt19937& rng, int limit)		{ return static_cast<int>(uniform(rng) * limit); }
+		static inline double	gaussian(std::mt19937& rng);
+		static inline std::size_t poisson(std::mt19937& rng, double mean);
+		static inline Index		nearest(std::vector<coordinates> const& positions, double x, double y, std::vector<char> const& taken);
+		static inline std::vector<std::pair<double, double>> kmeans(std::vector<coordinates> const& positions, TopologyOptions const& options);
+	};
+
+	inline Topology::Ptr TopologyGenerator::generate(TopologyOptions const& options)
+	{
+		std::vector<coordinates> node_positions = positions(options);
+		std::vector<Index> actuators = place_actuators(node_positions, options);
+		return std::make_shared<const Topology>(std::move(node_positions), std::move(actuators), options.comm_range_, options.x_dim_, options.y_dim_);
+	}
+
+	inline Topology::Ptr TopologyGenerator::generate_connected(TopologyOptions options, int attempts)
+	{
+		for (int attempt = 0; attempt < attempts; ++attempt, ++options.seed_)
+		{
+			Topology::Ptr topology = generate(options);
+			if (connected(*topology))
+			{
+				return topology;
+			}
+		}
+		return nullptr;
+	}
+
+	inline std::vector<coordinates> TopologyGenerator::positions(TopologyOptions const& options)
+	{
+		std::mt19937 rng(options.seed_);
+		std::vector<coordinates> result;
+		switch (options.layout_)
+		{
+		case Layout::grid:
+			result.reserve(static_cast<std::size_t>((options.x_dim_ + options.node_distance_ - 1) / options.node_distance_) *
+				((options.y_dim_ + options.node_distance_ - 1) / options.node_distance_));
+			for (int x = 0; x < options.x_dim_; x += options.node_distance_)
+			{
+				for (int y = 0; y < options.y_dim_; y += options.node_distance_)
+				{
+					result.push_back(coordinates(x, y));
+				}
+			}
+			break;
+		case Layout::hex:
+		{
+			const double row_height = options.node_distance_ * std::sqrt(3.0) / 2;
+			int row = 0;
+			for (double y = 0; y < options.y_dim_; y += row_height, ++row)
+			{
+				for (double x = (row % 2) * options.node_distance_ / 2.0; x < options.x_dim_; x += options.node_distance_)
+				{
+					result.push_back(coordinates(std::min(static_cast<int>(x + 0.5), options.x_dim_ - 1), std::min(static_cast<int>(y + 0.5), options.y_dim_ - 1)));
+				}
+			}
+			break;
+		}
+		case Layout::uniform:
+		case Layout::poisson:
+		{
+			const std::size_t count = options.layout_ == Layout::poisson ? poisson(rng, static_cast<double>(options.node_count_)) : options.node_count_;
+			result.reserve(count);
+			for (std::size_t node = 0; node < count; ++node)
+			{
+				const int x = uniform(rng, options.x_dim_);
+				result.push_back(coordinates(x, uniform(rng, options.y_dim_)));
+			}
+			break;
+		}
+		case Layout::clustered:
+		{
+			std::vector<std::pair<double, double>> centres(std::max(options.cluster_count_, 1));
+			for (auto& centre : centres)
+			{
+				centre.first = uniform(rng) * options.x_dim_;
+				centre.second = uniform(rng) * options.y_dim_;
+			}
+			result.reserve(options.node_count_);
+			for (std::size_t node = 0; node < options.node_count_; ++node)
+			{
+				auto const& centre = centres[uniform(rng, static_cast<int>(centres.size()))];
+				const double x = centre.first + gaussian(rng) * options.cluster_spread_;
+				const double y = centre.second + gaussian(rng) * options.cluster_spread_;
+				result.push_back(coordinates(std::min(std::max(static_cast<int>(x), 0), options.x_dim_ - 1),
+					std::min(std::max(static_cast<int>(y), 0), options.y_dim_ - 1)));
+			}
+			break;
+		}
+		}
+
+		if (options.layout_ != Layout::grid && options.layout_ != Layout::hex)
+		{
+			//Column by column like the grid, so neighbors get nearby indices; building the neighbor rows of a million
+			//random nodes is several times faster than in generation order
+			std::sort(result.begin(), result.end(), [](coordinates const& a, coordinates const& b) { return a.x_ != b.x_ ? a.x_ < b.x_ : a.y_ < b.y_; });
+		}
+		return result;
+	}
+
+	inline std::vector<TopologyGenerator::Index> TopologyGenerator::place_actuators(std::vector<coordinates> const& positions, TopologyOptions const& options)
+	{
+		const std::size_t count = std::min(static_cast<std::size_t>(std::max(options.actuator_count_, 0)), positions.size());
+		std::vector<Index> actuators;
+		actuators.reserve(count);
+		if (options.placement_ == ActuatorPlacement::first)
+		{
+			for (Index node = 0; node < count; ++node)
+			{
+				actuators.push_back(node);
+			}
+			return actuators;
+		}
+
+		std::vector<std::pair<double, double>> targets;
+		if (options.placement_ == ActuatorPlacement::kmeans)
+		{
+			targets = kmeans(positions, options);
+		}
+		else
+		{
+			const double corners[4][2] = { { 0, 0 }, { options.x_dim_ - 1.0, 0 }, { 0, options.y_dim_ - 1.0 }, { options.x_dim_ - 1.0, options.y_dim_ - 1.0 } };
+			for (std::size_t ndx = 0; ndx < count; ++ndx)
+			{
+				if (options.placement_ == ActuatorPlacement::centre)
+				{
+					targets.emplace_back(options.x_dim_ / 2.0, options.y_dim_ / 2.0);
+				}
+				else
+				{
+					targets.emplace_back(corners[ndx % 4][0], corners[ndx % 4][1]);
+				}
+			}
+		}
+
+		//Each target takes the nearest node not already an actuator, so several targets at one spot take a neighborhood
+		std::vector<char> taken(positions.size(), 0);
+		for (auto const& target : targets)
+		{
+			const Index node = nearest(positions, target.first, target.second, taken);
+			taken[node] = 1;
+			actuators.push_back(node);
+		}
+		return actuators;
+	}
+
+	inline bool TopologyGenerator::connected(Topology const& topology)
+	{
+		if (topology.size() == 0)
+		{
+			return true;
+		}
+		std::vector<char> reached(topology.size(), 0);
+		std::vector<Index> frontier;
+		frontier.reserve(topology.size());
+		frontier.push_back(0);
+		reached[0] = 1;
+		for (std::size_t head = 0; head < frontier.size(); ++head)
+		{
+			for (Index const* neighbor = topology.neighbors_begin(frontier[head]); neighbor != topology.neighbors_end(frontier[head]); ++neighbor)
+			{
+				if (!reached[*neighbor])
+				{
+					reached[*neighbor] = 1;
+					frontier.push_back(*neighbor);
+				}
+			}
+		}
+		return frontier.size() == topology.size();
+	}
+
+	inline double TopologyGenerator::gaussian(std::mt19937& rng)
+	{
+		//Box-Muller; 1 - u keeps the logarithm finite
+		const double u = 1.0 - uniform(rng);
+		const double v = uniform(rng);
+		return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+	}
+
+	inline std::size_t TopologyGenerator::poisson(std::mt19937& rng, double mean)
+	{
+		//Knuth's product of uniforms for small means; a rounded normal approximation is plenty for deployment sizes
+		if (mean < 30)
+		{
+			const double limit = std::exp(-mean);
+			std::size_t count = 0;
+			for (double product = uniform(rng); product > limit; product *= uniform(rng))
+			{
+				++count;
+			}
+			return count;
+		}
+		return static_cast<std::size_t>(std::max(0.0, mean + std::sqrt(mean) * gaussian(rng) + 0.5));
+	}
+
+	inline TopologyGenerator::Index TopologyGenerator::nearest(std::vector<coordinates> const& positions, double x, double y, std::vector<char> const& taken)
+	{
+		Index best = 0;
+		double best_distance = std::numeric_limits<double>::max();
+		for (Index node = 0; node < positions.size(); ++node)
+		{
+			const double dx = positions[node].x_ - x;
+			const double dy = positions[node].y_ - y;
+			if (!taken[node] && dx * dx + dy * dy < best_distance)
+			{
+				best_distance = dx * dx + dy * dy;
+				best = node;
+			}
+		}
+		return best;
+	}
+
+	inline std::vector<std::pair<double, double>> TopologyGenerator::kmeans(std::vector<coordinates> const& positions, TopologyOptions const& options)
+	{
+		//Lloyd's iterations from a k-means++ seeding; k is the actuator count, so every pass is O(N k)
+		const std::size_t k = std::min(static_cast<std::size_t>(std::max(options.actuator_count_, 0)), positions.size());
+		std::vector<std::pair<double, double>> centres;
+		if (k == 0)
+		{
+			return centres;
+		}
+		std::mt19937 rng(options.seed_ ^ 0x5bd1e995u);
+		std::vector<double> distance(positions.size(), std::numeric_limits<double>::max());
+		Index chosen = static_cast<Index>(uniform(rng) * positions.size());
+		while (centres.size() < k)
+		{
+			centres.emplace_back(positions[chosen].x_, positions[chosen].y_);
+			double total = 0;
+			for (std::size_t node = 0; node < positions.size(); ++node)
+			{
+				const double dx = positions[node].x_ - centres.back().first;
+				const double dy = positions[node].y_ - centres.back().second;
+				distance[node] = std::min(distance[node], dx * dx + dy * dy);
+				total += distance[node];
+			}
+			//The next centre is drawn with probability proportional to the squared distance to the nearest centre so far
+			double pick = uniform(rng) * total;
+			chosen = 0;
+			for (std::size_t node = 0; node < positions.size() && pick >= 0; ++node)
+			{
+				pick -= distance[node];
+				chosen = static_cast<Index>(node);
+			}
+		}
+
+		std::vector<double> sum_x(k), sum_y(k);
+		std::vector<std::size_t> members(k);
+		for (int iteration = 0; iteration < options.kmeans_iterations_; ++iteration)
+		{
+			std::fill(sum_x.begin(), sum_x.end(), 0.0);
+			std::fill(sum_y.begin(), sum_y.end(), 0.0);
+			std::fill(members.begin(), members.end(), 0);
+			for (auto const& position : positions)
+			{
+				std::size_t best = 0;
+				double best_distance = std::numeric_limits<double>::max();
+				for (std::size_t centre = 0; centre < k; ++centre)
+				{
+					const double dx = position.x_ - centres[centre].first;
+					const double dy = position.y_ - centres[centre].second;
+					if (dx * dx + dy * dy < best_distance)
+					{
+						best_distance = dx * dx + dy * dy;
+						best = centre;
+					}
+				}
+				sum_x[best] += position.x_;
+				sum_y[best] += position.y_;
+				++members[best];
+			}
+			for (std::size_t centre = 0; centre < k; ++centre)
+			{
+				if (members[centre] != 0)
+				{
+					centres[centre] = std::make_pair(sum_x[centre] / members[centre], sum_y[centre] / members[centre]);
+				}
+			}
+		}
+		return centres;
+	}
+}
@@ -0,0 +1,219 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ostream>
+#include <iostream>
+#include <climits>
+#include <cstdint>
+#include "hop_log_reader.h"
+
+namespace DC
+{
+	/*
+	 *	Writes a hop log (TSV or columnar) as Chrome Trace Event JSON, which chrome://tracing and Perfetto open directly.
+	 *	Every node gets its own track (tid = node label). Each hop becomes a slice on the sending node and each
+	 *	arrival a slice on the destination; slices of the same msgLabel are chained by flow arrows, so a message's
+	 *	path can be followed across the network, and the ack that Algorithm sends back along it as a second flow.
+	 *	One tick is shown as one millisecond. Events of the same node within a tick are laid side by side.
+	 *	Output is streamed through a small buffer, so the log never has to fit in memory.
+	 */
+	class TraceExporter
+	{
+	public:
+		static constexpr int	TICK_US = 1000;
+		static constexpr int	SLOT_US = 50;
+		static constexpr std::size_t FLUSH_BYTES = 1 << 16;
+
+		inline					TraceExporter(std::ostream& os, int first_tick, int last_tick);
+
+		inline void				begin();
+		inline void				add(MessageHopLogEntry const& entry);
+		inline void				end();
+
+	private:
+		inline void				add_flow(MessageHopLogEntry const& entry, bool ack, std::string const& common);
+		inline void				name_track(int node);
+		inline int				next_slot(int node, int tick);
+		inline void				flush();
+
+		std::ostream&			os_;
+		int						first_tick_;
+		int						last_tick_;
+		std::string				buffer_;
+		std::vector<bool>		named_;
+		std::vector<int>		slot_tick_;
+		std::vector<int>		slot_;
+		std::vector<std::uint8_t> flows_;		//By msgLabel, FLOW_* bits
+
+		static constexpr std::uint8_t FLOW_STARTED = 1;
+		static constexpr std::uint8_t FLOW_ENDED = 2;
+		static constexpr std::uint8_t ACK_STARTED = 4;
+	};
+
+	inline TraceExporter::TraceExporter(std::ostream& os, int first_tick, int last_tick) : os_(os), first_tick_(first_tick), last_tick_(last_tick)
+	{
+		buffer_.reserve(FLUSH_BYTES + 512);
+	}
+
+	inline void TraceExporter::begin()
+	{
+		buffer_ += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		buffer_ += "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"WSN\"}}";
+	}
+
+	inline void TraceExporter::add(MessageHopLogEntry const& entry)
+	{
+		if (entry.timestamp < first_tick_ || entry.timestamp > last_tick_)
+		{
+			return;
+		}
+
+		const bool heartbeat = entry.destNode < 0;
+		const bool ack = !entry.arrival_hop && entry.endTime != 0;
+		char const* category = heartbeat ? "heartbeat" : entry.arrival_hop ? "arrival" : ack ? "ack" : "data";
+		const int node = entry.arrival_hop ? entry.destNode : entry.hopSource;
+		if (node < 0)
+		{
+			return;
+		}
+		name_track(node);
+
+		std::string ts = std::to_string(static_cast<long long>(entry.timestamp) * TICK_US + next_slot(node, entry.timestamp) * SLOT_US);
+		std::string common = ",\"pid\":1,\"tid\":" + std::to_string(node) + ",\"ts\":" + ts;
+
+		buffer_ += ",\n{\"ph\":\"X\",\"name\":\"";
+		buffer_ += category;
+		buffer_ += ' ';
+		buffer_ += std::to_string(entry.msgLabel);
+		buffer_ += "\",\"cat\":\"";
+		buffer_ += category;
+		buffer_ += '"';
+		buffer_ += common;
+		buffer_ += ",\"dur\":" + std::to_string(SLOT_US);
+		buffer_ += ",\"args\":{\"msg\":" + std::to_string(entry.msgLabel);
+		buffer_ += ",\"src\":" + std::to_string(entry.srcNode);
+		buffer_ += ",\"dest\":" + std::to_string(entry.destNode);
+		buffer_ += ",\"hopSource\":" + std::to_string(entry.hopSource);
+		buffer_ += ",\"hopDest\":" + std::to_string(entry.hopDest);
+		buffer_ += ",\"hopCount\":" + std::to_string(entry.hopCount);
+		buffer_ += ",\"startTime\":" + std::to_string(entry.startTime) + "}}";
+
+		//Heartbeats have no destination to follow
+		if (!heartbeat)
+		{
+			add_flow(entry, ack, common);
+		}
+
+		if (buffer_.size() >= FLUSH_BYTES)
+		{
+			flush();
+		}
+	}
+
+	inline void TraceExporter::end()
+	{
+		buffer_ += "\n]}\n";
+		flush();
+		os_.flush();
+	}
+
+	inline void TraceExporter::add_flow(MessageHopLogEntry const& entry, bool ack, std::string const& common)
+	{
+		//A message's flow starts at its first hop in the window and ends at its first arrival; RASeR's broadcast
+		//copies join it as steps until then. The ack path is a flow of its own (same id, another name).
+		if (entry.msgLabel < 0)
+		{
+			return;
+		}
+		if (static_cast<std::size_t>(entry.msgLabel) >= flows_.size())
+		{
+			flows_.resize(entry.msgLabel + 1, 0);
+		}
+		std::uint8_t& state = flows_[entry.msgLabel];
+		char const* phase = "t";
+		if (ack)
+		{
+			phase = (state & ACK_STARTED) ? "t" : "s";
+			state |= ACK_STARTED;
+		}
+		else if (state & FLOW_ENDED)
+		{
+			return;
+		}
+		else if (entry.arrival_hop)
+		{
+			phase = "f";
+			state |= FLOW_ENDED;
+		}
+		else
+		{
+			phase = (state & FLOW_STARTED) ? "t" : "s";
+			state |= FLOW_STARTED;
+		}
+
+		buffer_ += ",\n{\"ph\":\"";
+		buffer_ += phase;
+		buffer_ += "\",\"name\":\"";
+		buffer_ += ack ? "ack" : "msg";
+		buffer_ += "\",\"cat\":\"flow\",\"id\":" + std::to_string(entry.msgLabel);
+		buffer_ += common;
+		buffer_ += ",\"bp\":\"e\"}";
+	}
+
+	inline void TraceExporter::name_track(int node)
+	{
+		if (static_cast<std::size_t>(node) >= named_.size())
+		{
+			named_.resize(node + 1, false);
+		}
+		if (named_[node])
+		{
+			return;
+		}
+		named_[node] = true;
+		buffer_ += ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(node);
+		buffer_ += ",\"name\":\"thread_name\",\"args\":{\"name\":\"node " + std::to_string(node) + "\"}}";
+		buffer_ += ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(node);
+		buffer_ += ",\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":" + std::to_string(node) + "}}";
+	}
+
+	inline int TraceExporter::next_slot(int node, int tick)
+	{
+		if (static_cast<std::size_t>(node) >= slot_tick_.size())
+		{
+			slot_tick_.resize(node + 1, INT_MIN);
+			slot_.resize(node + 1, 0);
+		}
+		if (slot_tick_[node] != tick)
+		{
+			slot_tick_[node] = tick;
+			slot_[node] = 0;
+		}
+		const int slot = slot_[node];
+		if (slot + 1 < TICK_US / SLOT_US)
+		{
+			++slot_[node];
+		}
+		return slot;
+	}
+
+	inline void TraceExporter::flush()
+	{
+		os_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+		buffer_.clear();
+	}
+
+	//Exports ticks [first_tick, last_tick] of a hop log; returns false if the log can't be read
+	inline bool export_hop_log_trace(std::string const& log_file, std::ostream& os, int first_tick = 0, int last_tick = INT_MAX)
+	{
+		TraceExporter exporter{ os, first_tick, last_tick };
+		exporter.begin();
+		const bool ok = HopLogReader::for_each(log_file, [&exporter](MessageHopLogEntry const& entry) { exporter.add(entry); });
+		exporter.end();
+		if (!ok)
+		{
+			std::cerr << "Could not read hop log " << log_file << std::endl;
+		}
+		return ok;
+	}
+}